@@ -0,0 +1,338 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// yxlsx_bench: whole document load and save throughput on synthetic workbooks.
+//
+// Every case saves and loads in two child processes of their own, so save_peak_rss_kb and
+// load_peak_rss_kb are the peaks of that phase alone.
+// Rows beyond the last row of a sheet continue on a new sheet, so 5000000 rows fit in one workbook.
+// One JSON object is printed per case and row count, e.g.
+//
+//   yxlsx_bench --rows 10000,1000000 --case numeric,string > results.jsonl
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <algorithm>
+
+#if defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#include "document.h"
+
+namespace {
+
+struct BenchCase {
+    const char* name {};
+    const char* description {};
+};
+
+constexpr BenchCase kCaseList[] {
+    { "numeric", "10 number columns" },
+    { "string", "10 string columns, one distinct string per 10 cells" },
+    { "sparse", "100 columns, one cell in 50 written" },
+    { "wide", "1000 number columns, rows / 100 rows" },
+    { "sheets", "50 sheets of rows / 50 rows, 10 mixed columns" },
+};
+
+// Peak resident set size of this process in KiB, -1 where it is not available.
+qint64 PeakRssKb()
+{
+#if defined(Q_OS_UNIX)
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+
+#if defined(Q_OS_MACOS)
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+// Calls write(sheet, row) for rows rows, continuing on a new sheet past the last row of a sheet.
+template <typename Write> void ForEachRow(yxlsx::Workbook& workbook, qint64 rows, Write write)
+{
+    auto sheet { workbook.GetCurrentWorksheet() };
+    int row {};
+
+    for (qint64 i = 0; i != rows; ++i) {
+        if (row == kMaxExcelRow) {
+            workbook.AppendSheet();
+            sheet = workbook.GetCurrentWorksheet();
+            row = 0;
+        }
+
+        write(*sheet, ++row);
+    }
+}
+
+// Fills document with the case, returns the number of cells written.
+qint64 Generate(yxlsx::Document& document, QStringView name, qint64 rows)
+{
+    auto& workbook { *document.GetWorkbook() };
+    qint64 cells {};
+
+    if (name == QLatin1String("numeric")) {
+        ForEachRow(workbook, rows, [&cells](yxlsx::Worksheet& sheet, int row) {
+            for (int column = 1; column <= 10; ++column)
+                sheet.Write(row, column, row * 0.5 + column);
+            cells += 10;
+        });
+    } else if (name == QLatin1String("string")) {
+        const qint64 distinct { std::max<qint64>(rows, 10) };
+        ForEachRow(workbook, rows, [&cells, distinct](yxlsx::Worksheet& sheet, int row) {
+            for (int column = 1; column <= 10; ++column)
+                sheet.Write(row, column, QStringLiteral("value %1").arg((cells + column) % distinct));
+            cells += 10;
+        });
+    } else if (name == QLatin1String("sparse")) {
+        ForEachRow(workbook, rows, [&cells](yxlsx::Worksheet& sheet, int row) {
+            for (int column = 1 + row % 50; column <= 100; column += 50) {
+                sheet.Write(row, column, row + column);
+                ++cells;
+            }
+        });
+    } else if (name == QLatin1String("wide")) {
+        ForEachRow(workbook, std::max<qint64>(rows / 100, 1), [&cells](yxlsx::Worksheet& sheet, int row) {
+            for (int column = 1; column <= 1000; ++column)
+                sheet.Write(row, column, row + column * 0.001);
+            cells += 1000;
+        });
+    } else if (name == QLatin1String("sheets")) {
+        const qint64 sheet_rows { std::max<qint64>(rows / 50, 1) };
+        for (int i = 0; i != 50; ++i) {
+            if (i != 0)
+                workbook.AppendSheet();
+
+            ForEachRow(workbook, sheet_rows, [&cells](yxlsx::Worksheet& sheet, int row) {
+                sheet.Write(row, 1, row);
+                sheet.Write(row, 2, QStringLiteral("item %1").arg(row % 1000));
+                sheet.Write(row, 3, row * 0.25);
+                sheet.Write(row, 4, row % 2 == 0);
+                for (int column = 5; column <= 10; ++column)
+                    sheet.Write(row, column, static_cast<double>(row ^ column));
+                cells += 10;
+            });
+        }
+    }
+
+    return cells;
+}
+
+// Path of the file a case and row count is saved to.
+QString CasePath(const QString& dir, const QString& name, qint64 rows) { return QDir(dir).filePath(QStringLiteral("%1_%2.xlsx").arg(name).arg(rows)); }
+
+// Generates and saves one case in this process and prints its timings, the file is left for RunLoad().
+int RunSave(const QString& name, qint64 rows, const QString& path)
+{
+    QElapsedTimer timer {};
+    yxlsx::Document document {};
+
+    timer.start();
+    const qint64 cells { Generate(document, name, rows) };
+    const qint64 generate_ns { timer.nsecsElapsed() };
+
+    timer.start();
+    if (!document.Save(path)) {
+        qWarning() << "Failed to save" << path;
+        return 1;
+    }
+    const qint64 save_ns { timer.nsecsElapsed() };
+
+    const QJsonObject result {
+        { QStringLiteral("cells"), cells },
+        { QStringLiteral("generate_ns"), generate_ns },
+        { QStringLiteral("save_ns"), save_ns },
+        { QStringLiteral("peak_rss_kb"), PeakRssKb() },
+    };
+
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact);
+    return 0;
+}
+
+// Loads the file saved by RunSave() in this process and prints its timing.
+int RunLoad(const QString& path)
+{
+    QElapsedTimer timer {};
+
+    timer.start();
+    yxlsx::Document document(path);
+    const qint64 load_ns { timer.nsecsElapsed() };
+
+    if (!document.IsLoadXlsx()) {
+        qWarning() << "Failed to load" << path;
+        return 1;
+    }
+
+    const QJsonObject result {
+        { QStringLiteral("load_ns"), load_ns },
+        { QStringLiteral("peak_rss_kb"), PeakRssKb() },
+    };
+
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact);
+    return 0;
+}
+
+// Runs this program with arguments in a child process, returns what it printed or an empty object on failure.
+QJsonObject RunChild(const QStringList& arguments)
+{
+    QProcess child {};
+    child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    child.start(QCoreApplication::applicationFilePath(), arguments);
+
+    if (!child.waitForFinished(-1) || child.exitStatus() != QProcess::NormalExit || child.exitCode() != 0)
+        return {};
+
+    return QJsonDocument::fromJson(child.readAllStandardOutput()).object();
+}
+
+// Saves and loads one case in two child processes and prints its result.
+bool RunCase(const QString& name, qint64 rows, const QString& dir)
+{
+    const QString path { CasePath(dir, name, rows) };
+    const QStringList arguments { QStringLiteral("--case"), name, QStringLiteral("--rows"), QString::number(rows), QStringLiteral("--dir"), dir };
+
+    const QJsonObject save { RunChild(QStringList { QStringLiteral("--child"), QStringLiteral("save") } + arguments) };
+    const QJsonObject load { save.isEmpty() ? QJsonObject() : RunChild(QStringList { QStringLiteral("--child"), QStringLiteral("load") } + arguments) };
+
+    const qint64 file_bytes { QFileInfo(path).size() };
+    QFile::remove(path);
+
+    if (save.isEmpty() || load.isEmpty())
+        return false;
+
+    const qint64 cells { save.value(QStringLiteral("cells")).toInteger() };
+    const qint64 generate_ns { save.value(QStringLiteral("generate_ns")).toInteger() };
+    const qint64 save_ns { save.value(QStringLiteral("save_ns")).toInteger() };
+    const qint64 load_ns { load.value(QStringLiteral("load_ns")).toInteger() };
+
+    auto per_second = [cells](qint64 ns) { return ns > 0 ? static_cast<double>(cells) * 1e9 / static_cast<double>(ns) : 0.0; };
+
+    const QJsonObject result {
+        { QStringLiteral("case"), name },
+        { QStringLiteral("rows"), rows },
+        { QStringLiteral("cells"), cells },
+        { QStringLiteral("generate_ms"), static_cast<double>(generate_ns) / 1e6 },
+        { QStringLiteral("save_ms"), static_cast<double>(save_ns) / 1e6 },
+        { QStringLiteral("load_ms"), static_cast<double>(load_ns) / 1e6 },
+        { QStringLiteral("save_cells_per_s"), per_second(save_ns) },
+        { QStringLiteral("load_cells_per_s"), per_second(load_ns) },
+        { QStringLiteral("file_bytes"), file_bytes },
+        { QStringLiteral("bytes_per_cell"), cells > 0 ? static_cast<double>(file_bytes) / static_cast<double>(cells) : 0.0 },
+        { QStringLiteral("save_peak_rss_kb"), save.value(QStringLiteral("peak_rss_kb")).toInteger() },
+        { QStringLiteral("load_peak_rss_kb"), load.value(QStringLiteral("peak_rss_kb")).toInteger() },
+    };
+
+    QTextStream(stdout) << QJsonDocument(result).toJson(QJsonDocument::Compact) << Qt::endl;
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser {};
+    parser.setApplicationDescription(QStringLiteral("Load and save throughput of YXlsx on synthetic workbooks."));
+    parser.addHelpOption();
+
+    QString case_help { QStringLiteral("Comma separated cases, all by default:") };
+    for (const auto& bench_case : kCaseList)
+        case_help += QStringLiteral("\n  %1: %2").arg(QLatin1String(bench_case.name), QLatin1String(bench_case.description));
+
+    const QCommandLineOption case_option(QStringLiteral("case"), case_help, QStringLiteral("names"));
+    const QCommandLineOption rows_option(
+        QStringLiteral("rows"), QStringLiteral("Comma separated row counts, default 10000,100000,1000000."), QStringLiteral("counts"), QStringLiteral("10000,100000,1000000"));
+    const QCommandLineOption dir_option(QStringLiteral("dir"), QStringLiteral("Directory for the generated files, a temporary one by default."), QStringLiteral("path"));
+    QCommandLineOption child_option(QStringLiteral("child"), QStringLiteral("Run one phase, save or load, of a single case and row count in this process."), QStringLiteral("phase"));
+    child_option.setFlags(QCommandLineOption::HiddenFromHelp);
+
+    parser.addOptions({ case_option, rows_option, dir_option, child_option });
+    parser.process(app);
+
+    QStringList case_list { parser.value(case_option).split(QLatin1Char(','), Qt::SkipEmptyParts) };
+    if (case_list.isEmpty()) {
+        for (const auto& bench_case : kCaseList)
+            case_list.append(QLatin1String(bench_case.name));
+    }
+
+    for (const QString& name : std::as_const(case_list)) {
+        if (std::ranges::none_of(kCaseList, [&name](const BenchCase& bench_case) { return name == QLatin1String(bench_case.name); })) {
+            qWarning() << "Unknown case:" << name;
+            return 1;
+        }
+    }
+
+    QList<qint64> row_list {};
+    for (const QString& count : parser.value(rows_option).split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        bool ok { false };
+        const qint64 rows { count.toLongLong(&ok) };
+        if (!ok || rows <= 0) {
+            qWarning() << "Invalid row count:" << count;
+            return 1;
+        }
+        row_list.append(rows);
+    }
+
+    QTemporaryDir temporary_dir {};
+    const QString dir { parser.isSet(dir_option) ? parser.value(dir_option) : temporary_dir.path() };
+
+    if (parser.isSet(child_option)) {
+        const QString phase { parser.value(child_option) };
+        const QString path { CasePath(dir, case_list.constFirst(), row_list.constFirst()) };
+
+        if (phase == QLatin1String("save"))
+            return RunSave(case_list.constFirst(), row_list.constFirst(), path);
+        if (phase == QLatin1String("load"))
+            return RunLoad(path);
+
+        qWarning() << "Unknown phase:" << phase;
+        return 1;
+    }
+
+    int failed {};
+    for (const QString& name : std::as_const(case_list)) {
+        for (qint64 rows : std::as_const(row_list)) {
+            if (!RunCase(name, rows, dir)) {
+                qWarning() << "Case failed:" << name << rows;
+                ++failed;
+            }
+        }
+    }
+
+    return failed == 0 ? 0 : 1;
+}
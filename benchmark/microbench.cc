@@ -0,0 +1,349 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// yxlsx_microbench: per-cell hot paths in nanoseconds per call.
+//
+// Each benchmark is timed over enough calls to run for at least --min-ms, the fastest of --repeat
+// runs is reported. Results are JSON, keyed by benchmark name.
+//
+//   yxlsx_microbench --save-baseline benchmark/baseline.json     record a baseline
+//   yxlsx_microbench --baseline benchmark/baseline.json          compare, exit 1 on a regression
+//
+// A baseline records the machine and build type next to the results, comparing against a baseline
+// recorded elsewhere warns, as the numbers are only comparable on the same machine and build.
+// A comparison also fails if the baseline holds no results, or none for a benchmark that ran.
+
+#include <QBuffer>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <QTextStream>
+#include <QXmlStreamWriter>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <tuple>
+
+#include "cellcodec.h"
+#include "dimension.h"
+#include "sharedstring.h"
+#include "utility.h"
+
+// Set by CMakeLists.txt to the build configuration.
+#ifndef YXLSX_BUILD_TYPE
+#define YXLSX_BUILD_TYPE "unknown"
+#endif
+
+namespace {
+
+using yxlsx::CellType;
+
+struct Benchmark {
+    QString name {};
+    std::function<qint64(qint64)> run {}; // runs the hot path n times, returns a value to keep it alive
+};
+
+volatile qint64 g_sink {};
+
+// Fastest time per call in nanoseconds over repeat runs of at least min_ns each.
+double Measure(const Benchmark& benchmark, qint64 min_ns, int repeat)
+{
+    QElapsedTimer timer {};
+    qint64 count { 1 };
+
+    // Grow the call count until one run lasts min_ns.
+    for (;;) {
+        timer.start();
+        g_sink = g_sink + benchmark.run(count);
+        const qint64 elapsed { timer.nsecsElapsed() };
+
+        if (elapsed >= min_ns)
+            break;
+
+        count = elapsed > 0 ? std::max(count * 2, count * min_ns / elapsed + 1) : count * 16;
+    }
+
+    double best { std::numeric_limits<double>::max() };
+    for (int i = 0; i != repeat; ++i) {
+        timer.start();
+        g_sink = g_sink + benchmark.run(count);
+        best = std::min(best, static_cast<double>(timer.nsecsElapsed()) / static_cast<double>(count));
+    }
+
+    return best;
+}
+
+// Where the results are measured, stored in a baseline and compared with it.
+QJsonObject Environment()
+{
+    return QJsonObject {
+        { QStringLiteral("host"), QSysInfo::machineHostName() },
+        { QStringLiteral("cpu"), QSysInfo::currentCpuArchitecture() },
+        { QStringLiteral("os"), QSysInfo::prettyProductName() },
+        { QStringLiteral("qt"), QLatin1String(qVersion()) },
+        { QStringLiteral("build_type"), QStringLiteral(YXLSX_BUILD_TYPE) },
+    };
+}
+
+QList<Benchmark> CreateBenchmark()
+{
+    using namespace yxlsx;
+
+    auto shared_string { QSharedPointer<SharedString>::create(OperationMode::kCreateNew) };
+
+    // 4096 distinct strings, the lookups below cycle through them.
+    QStringList string_list {};
+    for (int i = 0; i != 4096; ++i)
+        string_list.append(QStringLiteral("item %1").arg(i));
+    for (const QString& string : std::as_const(string_list))
+        shared_string->SetSharedString(string);
+
+    QStringList coordinate_list {};
+    for (int i = 0; i != 1024; ++i)
+        coordinate_list.append(Utility::ComposeCoordinate(1 + i * 997 % 100000, 1 + i * 31 % 16384));
+
+    QList<Benchmark> list {};
+
+    list.append({ QStringLiteral("Utility::ParseCoordinate"), [coordinate_list](qint64 n) {
+                     qint64 sum {};
+                     for (qint64 i = 0; i != n; ++i)
+                         sum += Utility::ParseCoordinate(coordinate_list.at(i & 1023)).row;
+                     return sum;
+                 } });
+
+    list.append({ QStringLiteral("Utility::ComposeCoordinate"), [](qint64 n) {
+                     qint64 sum {};
+                     for (qint64 i = 0; i != n; ++i)
+                         sum += Utility::ComposeCoordinate(1 + static_cast<int>(i & 0xFFFF), 1 + static_cast<int>(i & 0x3FFF)).size();
+                     return sum;
+                 } });
+
+    const QList<std::pair<const char*, QVariant>> variant_list {
+        { "number", QVariant(3.25) },
+        { "boolean", QVariant(true) },
+        { "string", QVariant(QStringLiteral("text")) },
+        { "datetime", QVariant(QDateTime(QDate(2024, 1, 31), QTime(12, 0))) },
+    };
+
+    for (const auto& entry : variant_list) {
+        const QVariant value { entry.second };
+        list.append({ QStringLiteral("CellCodec::DetermineCellType/%1").arg(QLatin1String(entry.first)), [value](qint64 n) {
+                         qint64 sum {};
+                         for (qint64 i = 0; i != n; ++i)
+                             sum += static_cast<qint64>(CellCodec::DetermineCellType(value));
+                         return sum;
+                     } });
+    }
+
+    const QList<std::tuple<const char*, QString, CellType>> text_list {
+        { "number", QStringLiteral("12345.678"), CellType::kNumber },
+        { "boolean", QStringLiteral("1"), CellType::kBoolean },
+        { "datetime", QStringLiteral("2024-01-31T12:00:00"), CellType::kDateTime },
+        { "shared_string", QStringLiteral("42"), CellType::kSharedString },
+        { "inline_string", QStringLiteral("inline text"), CellType::kInlineString },
+    };
+
+    for (const auto& entry : text_list) {
+        const CellType cell_type { std::get<2>(entry) };
+
+        // Tokenized as RowReader hands it over, inline strings already in UTF-8.
+        RawCell raw_cell { 1, cell_type, {} };
+        if (cell_type == CellType::kInlineString)
+            raw_cell.utf8 = std::get<1>(entry).toUtf8();
+        else
+            raw_cell.text = std::get<1>(entry);
+
+        list.append({ QStringLiteral("CellCodec::ParseCellValue/%1").arg(QLatin1String(std::get<0>(entry))), [shared_string, raw_cell, cell_type](qint64 n) {
+                         qint64 sum {};
+                         for (qint64 i = 0; i != n; ++i) {
+                             const QVariant value { CellCodec::ParseCellValue(raw_cell, shared_string.data()) };
+
+                             // A shared string cell takes a reference, give it back so the count stays put.
+                             if (cell_type == CellType::kSharedString && value.isValid())
+                                 shared_string->DecrementReference(value.toInt());
+
+                             sum += value.isValid();
+                         }
+                         return sum;
+                     } });
+    }
+
+    const QList<std::pair<const char*, Cell>> cell_list {
+        { "number", Cell { 12345.678, CellType::kNumber } },
+        { "boolean", Cell { true, CellType::kBoolean } },
+        { "datetime", Cell { QDateTime(QDate(2024, 1, 31), QTime(12, 0)), CellType::kDateTime } },
+        { "shared_string", Cell { 42, CellType::kSharedString } },
+        { "inline_string", Cell { QStringLiteral("inline text").toUtf8(), CellType::kInlineString } },
+    };
+
+    for (const auto& entry : cell_list) {
+        const Cell cell { entry.second };
+        list.append({ QStringLiteral("CellCodec::ComposeCell/%1").arg(QLatin1String(entry.first)), [shared_string, cell](qint64 n) {
+                         QByteArray xml {};
+                         QBuffer buffer(&xml);
+                         buffer.open(QIODevice::WriteOnly);
+                         QXmlStreamWriter writer(&buffer);
+
+                         for (qint64 i = 0; i != n; ++i) {
+                             // Keep the buffer small, the cost of growing it is not the cell's.
+                             if ((i & 1023) == 0)
+                                 buffer.seek(0);
+
+                             CellCodec::ComposeCell(writer, 1 + static_cast<int>(i & 0xFFFF), 1 + static_cast<int>(i & 0xFF), cell, shared_string.data());
+                         }
+                         return buffer.pos();
+                     } });
+    }
+
+    list.append({ QStringLiteral("SharedString::SetSharedString/existing"), [shared_string, string_list](qint64 n) {
+                     qint64 sum {};
+                     for (qint64 i = 0; i != n; ++i) {
+                         const int index { shared_string->SetSharedString(string_list.at(i & 4095)) };
+                         shared_string->DecrementReference(index);
+                         sum += index;
+                     }
+                     return sum;
+                 } });
+
+    list.append({ QStringLiteral("SharedString::GetSharedStringIndex"), [shared_string, string_list](qint64 n) {
+                     qint64 sum {};
+                     for (qint64 i = 0; i != n; ++i)
+                         sum += shared_string->GetSharedStringIndex(string_list.at(i & 4095));
+                     return sum;
+                 } });
+
+    list.append({ QStringLiteral("Dimension::Extend"), [](qint64 n) {
+                     Dimension dimension {};
+                     for (qint64 i = 0; i != n; ++i)
+                         dimension.Extend(1 + static_cast<int>(i & 0xFFFFF), 1 + static_cast<int>(i & 0x3FFF));
+                     return static_cast<qint64>(dimension.RowCount());
+                 } });
+
+    return list;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser {};
+    parser.setApplicationDescription(QStringLiteral("Per-cell hot paths of YXlsx, in nanoseconds per call."));
+    parser.addHelpOption();
+
+    const QCommandLineOption filter_option(QStringLiteral("filter"), QStringLiteral("Run only benchmarks whose name contains text."), QStringLiteral("text"));
+    const QCommandLineOption min_option(QStringLiteral("min-ms"), QStringLiteral("Minimum duration of one run, default 100."), QStringLiteral("ms"), QStringLiteral("100"));
+    const QCommandLineOption repeat_option(QStringLiteral("repeat"), QStringLiteral("Runs per benchmark, the fastest counts, default 5."), QStringLiteral("count"), QStringLiteral("5"));
+    const QCommandLineOption save_option(QStringLiteral("save-baseline"), QStringLiteral("Write the results to file as a baseline."), QStringLiteral("file"));
+    const QCommandLineOption baseline_option(QStringLiteral("baseline"), QStringLiteral("Compare the results with the baseline in file."), QStringLiteral("file"));
+    const QCommandLineOption threshold_option(
+        QStringLiteral("threshold"), QStringLiteral("Slowdown reported as a regression, default 0.10 for 10%."), QStringLiteral("ratio"), QStringLiteral("0.10"));
+
+    parser.addOptions({ filter_option, min_option, repeat_option, save_option, baseline_option, threshold_option });
+    parser.process(app);
+
+    const qint64 min_ns { std::max<qint64>(parser.value(min_option).toLongLong(), 1) * 1000000 };
+    const int repeat { std::max(parser.value(repeat_option).toInt(), 1) };
+    const double threshold { parser.value(threshold_option).toDouble() };
+    const QString filter { parser.value(filter_option) };
+
+    QJsonObject baseline {};
+    if (parser.isSet(baseline_option)) {
+        QFile file(parser.value(baseline_option));
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Failed to open baseline:" << file.fileName();
+            return 1;
+        }
+        const QJsonObject root { QJsonDocument::fromJson(file.readAll()).object() };
+        baseline = root.value(QStringLiteral("results")).toObject();
+
+        if (baseline.isEmpty()) {
+            qWarning() << "Baseline holds no results, record one with --save-baseline:" << file.fileName();
+            return 1;
+        }
+
+        const QJsonObject recorded { root.value(QStringLiteral("environment")).toObject() };
+        const QJsonObject current { Environment() };
+        for (auto it = current.constBegin(); it != current.constEnd(); ++it) {
+            if (recorded.value(it.key()) != it.value())
+                qWarning().noquote() << "Baseline" << it.key() << "is" << recorded.value(it.key()).toString() << "but this run is" << it.value().toString()
+                                     << "- the comparison is not meaningful";
+        }
+    }
+
+    QTextStream out(stdout);
+    QJsonObject result {};
+    int regression {};
+    int missing {};
+
+    for (const auto& benchmark : CreateBenchmark()) {
+        if (!filter.isEmpty() && !benchmark.name.contains(filter))
+            continue;
+
+        const double ns { Measure(benchmark, min_ns, repeat) };
+        result.insert(benchmark.name, ns);
+
+        out << qSetFieldWidth(48) << Qt::left << benchmark.name << qSetFieldWidth(0) << QString::number(ns, 'f', 2) << " ns";
+
+        if (baseline.contains(benchmark.name)) {
+            const double base { baseline.value(benchmark.name).toDouble() };
+            const double change { base > 0.0 ? ns / base - 1.0 : 0.0 };
+            out << "  " << (change >= 0.0 ? "+" : "") << QString::number(change * 100.0, 'f', 1) << "%";
+
+            if (change > threshold) {
+                out << "  REGRESSION";
+                ++regression;
+            }
+        } else if (parser.isSet(baseline_option)) {
+            out << "  (no baseline)";
+            ++missing;
+        }
+
+        out << Qt::endl;
+    }
+
+    if (parser.isSet(save_option)) {
+        QFile file(parser.value(save_option));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qWarning() << "Failed to write baseline:" << file.fileName();
+            return 1;
+        }
+        const QJsonObject root {
+            { QStringLiteral("environment"), Environment() },
+            { QStringLiteral("results"), result },
+        };
+        file.write(QJsonDocument(root).toJson());
+    }
+
+    if (missing != 0)
+        qWarning() << missing << "benchmarks have no baseline entry, record the baseline again with --save-baseline.";
+
+    return regression == 0 && missing == 0 ? 0 : 1;
+}
@@ -26,6 +26,7 @@
 #define YXLSX_CELL_H
 
 #include <QVariant>
+#include <utility>
 
 #include "namespace.h"
 
@@ -35,19 +36,24 @@ YXLSX_BEGIN_NAMESPACE
 // https://ecma-international.org/publications-and-standards/standards/ecma-376/
 enum class CellType { kEmpty, kBoolean, kDateTime, kNumber, kSharedString, kInlineString, kError };
 
-enum class StringType { kSharedString, kInlineString };
+// kAuto samples the strings written to each column and picks shared or inline per column,
+// a column of mostly distinct values (ids, notes) is written inline when the file is saved.
+// Only the strings written with kAuto follow the decision, other cells of the column keep their type.
+enum class StringType { kSharedString, kInlineString, kAuto };
 
 // Cell is a lightweight value container.
 // - No formulas
 // - No formatting
 // - Strings may be stored as shared strings or inline strings.
+//   A shared string cell holds the index of its string in the workbook's SharedString table,
+//   an inline string cell holds its text as UTF-8 in a QByteArray.
 // - DateTime represents ISO 8601 date cells (t="d").
 struct Cell final {
     Cell() = default;
 
-    explicit Cell(const QVariant& value, CellType type)
+    explicit Cell(QVariant value, CellType type)
         : type(type)
-        , value(value)
+        , value(std::move(value))
     {
     }
 
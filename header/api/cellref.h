@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_CELLREF_H
+#define YXLSX_CELLREF_H
+
+#include <QUtf8StringView>
+#include <QVariant>
+#include <ranges>
+
+#include "cell.h"
+#include "cellstore.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+class SharedString;
+
+// CellRef is a lightweight view of one stored cell, as yielded by RowRef::Cells().
+// - Nothing is copied: Text() views the shared string table or the inline cell directly.
+// - A CellRef is valid until the worksheet or its shared string table is modified.
+// - With LoadOptions::lazy_shared_string, reading a not yet decoded string may move the table,
+//   so a Text() view should be used before the next cell is read, and cells of one workbook
+//   must not be read from several threads at once.
+class CellRef final {
+public:
+    CellRef(int row, const CellStore::Entry& entry, const SharedString* shared_string)
+        : row_ { row }
+        , entry_ { &entry }
+        , shared_string_ { shared_string }
+    {
+    }
+
+    inline int Row() const { return row_; }
+    inline int Column() const { return entry_->column; }
+    inline CellType Type() const { return entry_->cell.type; }
+    inline bool IsBlank() const { return !entry_->cell.value.isValid(); }
+
+    inline double Number() const { return entry_->cell.value.toDouble(); }
+    inline bool Boolean() const { return entry_->cell.value.toBool(); }
+    QUtf8StringView Text() const;
+    QVariant Value() const;
+
+private:
+    int row_ {};
+    const CellStore::Entry* entry_ {};
+    const SharedString* shared_string_ {};
+};
+
+// RowRef is a lightweight view of one non-empty row, as yielded by Worksheet::Rows().
+class RowRef final {
+public:
+    RowRef(int row, const CellStore::Row& entry_list, const SharedString* shared_string)
+        : row_ { row }
+        , entry_list_ { &entry_list }
+        , shared_string_ { shared_string }
+    {
+    }
+
+    inline int Row() const { return row_; }
+    inline qsizetype CellCount() const { return entry_list_->size(); }
+
+    // Stored cells in column order.
+    inline auto Cells() const
+    {
+        return *entry_list_ | std::views::transform([row = row_, shared_string = shared_string_](const CellStore::Entry& entry) {
+            return CellRef(row, entry, shared_string);
+        });
+    }
+
+private:
+    int row_ {};
+    const CellStore::Row* entry_list_ {};
+    const SharedString* shared_string_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_CELLREF_H
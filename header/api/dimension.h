@@ -33,9 +33,24 @@ class Dimension final {
 public:
     Dimension() = default;
     explicit Dimension(const QString& dimension);
+    Dimension(int top_row, int left_column, int bottom_row, int right_column)
+        : top_row_ { top_row }
+        , left_column_ { left_column }
+        , bottom_row_ { bottom_row }
+        , right_column_ { right_column }
+    {
+    }
 
     QString ComposeDimension(bool row_abs = false, bool col_abs = false) const;
 
+    inline int TopRow() const { return top_row_; }
+    inline int LeftColumn() const { return left_column_; }
+    inline int BottomRow() const { return bottom_row_; }
+    inline int RightColumn() const { return right_column_; }
+
+    inline int RowCount() const { return IsValid() ? bottom_row_ - top_row_ + 1 : 0; }
+    inline int ColumnCount() const { return IsValid() ? right_column_ - left_column_ + 1 : 0; }
+
     inline bool IsValid() const
     {
         return top_row_ != kInvalidValue && left_column_ != kInvalidValue && bottom_row_ != kInvalidValue && right_column_ != kInvalidValue && top_row_ >= 1
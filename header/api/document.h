@@ -26,14 +26,19 @@
 #define YXLSX_DOCUMENT_H
 
 #include "contenttype.h"
+#include "documentstats.h"
+#include "loadoptions.h"
 #include "workbook.h"
 
 YXLSX_BEGIN_NAMESPACE
 
 class Document final : public QObject {
+    friend class Snapshot;
+
 public:
     explicit Document(QObject* parent = nullptr);
     explicit Document(const QString& xlsx_name, QObject* parent = nullptr);
+    explicit Document(const QString& xlsx_name, const LoadOptions& options, QObject* parent = nullptr);
 
     QString GetProperty(const QString& key) const;
     void SetProperty(const QString& key, const QString& property);
@@ -42,6 +47,13 @@ public:
     bool Save(const QString& xlsx_name) const;
 
     bool IsLoadXlsx() const { return is_load_xlsx_; }
+
+    // Stats of the loads and saves since collection was enabled, empty unless enabled.
+    // Loading records stats if LoadOptions::collect_stats is set.
+    inline void SetCollectStats(bool collect) { load_options_.collect_stats = collect; }
+    inline const DocumentStats& GetStats() const { return stats_; }
+    inline void ClearStats() { stats_.Clear(); }
+
     QSharedPointer<Workbook> GetWorkbook() const { return workbook_; }
     QStringList GetProperty() const { return document_property_hash_.keys(); }
 
@@ -50,14 +62,18 @@ private:
     bool ParseXlsx(QIODevice* device);
     bool ComposeXlsx(QIODevice* device) const;
 
+    inline DocumentStats* Stats() const { return load_options_.collect_stats ? &stats_ : nullptr; }
+
 private:
     bool is_load_xlsx_ { false };
 
     QString xlsx_name_ {}; // name of the .xlsx file
+    LoadOptions load_options_ {};
 
     QHash<QString, QString> document_property_hash_ {}; // core, app and custom properties
     QSharedPointer<Workbook> workbook_ {};
     QSharedPointer<ContentType> content_type_ {};
+    mutable DocumentStats stats_ {}; // filled by the const save as well
 };
 
 YXLSX_END_NAMESPACE
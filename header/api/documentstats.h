@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_DOCUMENTSTATS_H
+#define YXLSX_DOCUMENTSTATS_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include "cell.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// PhaseStats is the time one phase spent on one part of the package.
+// - phase is one of "load", "save", "snapshot", "inflate", "parse", "compact", "compose" or "deflate".
+// - part is the path inside the package, empty for the whole document phases.
+// - bytes is the uncompressed size of the part, 0 where it does not apply.
+struct PhaseStats {
+    QString phase {};
+    QString part {};
+    qint64 wall_ns {};
+    qint64 cpu_ns {}; // CPU time of the calling thread, -1 where the platform has no per thread clock
+    qint64 bytes {};
+};
+
+// DocumentStats is filled by Document while it loads and saves, see Document::SetCollectStats().
+// - Phases are listed in the order they finished; "load" and "save" enclose the others.
+// - Counters add up over every load and save until Clear().
+// - cell_count_hash counts the cells kept by a load, by type, after LoadOptions filtering.
+// - Allocations are not counted, Qt has no allocator hook to count them with.
+struct DocumentStats {
+    QList<PhaseStats> phase_list {};
+
+    qint64 bytes_inflated {}; // uncompressed bytes read from the package
+    qint64 bytes_deflated {}; // uncompressed bytes written to the package
+    qint64 bytes_written {}; // size of the saved package
+    qint64 shared_string_read {}; // strings loaded from the shared string part
+    qint64 shared_string_written {}; // strings saved to the shared string part
+    QHash<CellType, qint64> cell_count_hash {};
+
+    // Total wall time of phase over all parts, in nanoseconds.
+    qint64 WallNs(QStringView phase) const;
+    inline void Clear() { *this = DocumentStats {}; }
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_DOCUMENTSTATS_H
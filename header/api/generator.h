@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_GENERATOR_H
+#define YXLSX_GENERATOR_H
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// Generator<T> is a minimal single pass coroutine range, like C++23 std::generator.
+// - The body runs only when the range is advanced, and stops at each co_yield until the next increment.
+// - A yielded value lives in the coroutine frame; the reference from operator* is valid until the next increment.
+// - An exception thrown by the body is rethrown from begin() or operator++.
+template <typename T> class Generator {
+public:
+    struct promise_type {
+        T* value {};
+        std::exception_ptr exception {};
+
+        inline Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        inline std::suspend_always initial_suspend() noexcept { return {}; }
+        inline std::suspend_always final_suspend() noexcept { return {}; }
+
+        inline std::suspend_always yield_value(T& yielded) noexcept
+        {
+            value = std::addressof(yielded);
+            return {};
+        }
+
+        // A temporary lives until the end of the co_yield expression, past the suspension.
+        inline std::suspend_always yield_value(T&& yielded) noexcept
+        {
+            value = std::addressof(yielded);
+            return {};
+        }
+
+        inline void return_void() noexcept { }
+        inline void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+        void await_transform() = delete; // co_await is not meaningful in a generator
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = T;
+
+        Iterator() = default;
+        explicit Iterator(std::coroutine_handle<promise_type> handle)
+            : handle_ { handle }
+        {
+        }
+
+        inline T& operator*() const { return *handle_.promise().value; }
+        inline T* operator->() const { return handle_.promise().value; }
+
+        inline Iterator& operator++()
+        {
+            Resume(handle_);
+            return *this;
+        }
+
+        inline void operator++(int) { ++*this; }
+
+        inline bool operator==(std::default_sentinel_t) const { return !handle_ || handle_.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle_ {};
+    };
+
+    Generator() = default;
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    Generator(Generator&& other) noexcept
+        : handle_ { std::exchange(other.handle_, {}) }
+    {
+    }
+
+    Generator& operator=(Generator&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~Generator()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    // Runs the body up to its first co_yield, so begin() is called once per generator.
+    inline Iterator begin()
+    {
+        Resume(handle_);
+        return Iterator(handle_);
+    }
+
+    inline std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle)
+        : handle_ { handle }
+    {
+    }
+
+    static void Resume(std::coroutine_handle<promise_type> handle)
+    {
+        if (!handle || handle.done())
+            return;
+
+        handle.resume();
+
+        if (auto exception { std::exchange(handle.promise().exception, {}) })
+            std::rethrow_exception(exception);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_GENERATOR_H
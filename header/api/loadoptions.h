@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_LOADOPTIONS_H
+#define YXLSX_LOADOPTIONS_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSet>
+#include <functional>
+
+#include "cell.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+class SharedString;
+
+// RawCell is a cell as tokenized from the sheet xml, before its value is decoded.
+// - For shared strings, text holds the index into the shared string table.
+// - For inline strings, utf8 holds the string itself in UTF-8, as it is stored, and text is null.
+// - A cell without <v> or <is> has both null, see IsEmpty().
+struct RawCell {
+    int column {};
+    CellType type { CellType::kNumber };
+    QString text {};
+    QByteArray utf8 {};
+
+    inline bool IsEmpty() const { return text.isNull() && utf8.isNull(); }
+
+    // The value as text, an inline string converted from UTF-8.
+    inline QString Text() const { return type == CellType::kInlineString ? QString::fromUtf8(utf8) : text; }
+
+    inline int SharedStringIndex() const
+    {
+        bool ok { false };
+        const int index { text.toInt(&ok) };
+        return ok ? index : -1;
+    }
+};
+
+// RawRow holds the tokenized cells of one <row>.
+struct RawRow {
+    int row {};
+    QList<RawCell> cells {};
+    const SharedString* shared_string {}; // table the shared string indices refer to
+
+    const RawCell* Find(int column) const;
+};
+
+// Returns true to keep the row.
+using RowPredicate = std::function<bool(const RawRow& row)>;
+
+// LoadOptions controls which part of a worksheet is kept while loading.
+// - Rows outside [first_row, last_row] are skipped without reading their cells.
+// - If columns is not empty, only the listed columns (1-indexed) are kept.
+// - If row_predicate is set, it runs on every tokenized row; rejected rows are never decoded or stored.
+// - Skipped cells are never decoded, so the shared strings they reference are not touched.
+// - If row_index_stride is positive, a sidecar index of every Nth row is kept next to the file;
+//   later loads with a first_row start parsing at the nearest indexed row.
+// - If use_snapshot is set, an unfiltered load is cached in a binary snapshot next to the file
+//   and later loads of the unchanged file are served from it.
+// - If lazy_shared_string is set, only the position of each shared string is recorded on load;
+//   a string is decoded the first time it is read, and the table is fully decoded and indexed
+//   only when the workbook is written to or saved. Until then reads modify the table: they must
+//   not run concurrently, string views may be invalidated by the next read, and looking up a
+//   string's index scans the table.
+// - If collect_stats is set, the document records per phase timings and counters, see DocumentStats.
+// - The same options are applied to every worksheet of the document.
+struct LoadOptions {
+    int first_row { 1 };
+    int last_row { kMaxExcelRow };
+    QSet<int> columns {};
+    RowPredicate row_predicate {};
+    int row_index_stride { 0 };
+    bool use_snapshot { false };
+    bool lazy_shared_string { false };
+    bool collect_stats { false };
+
+    inline bool HasFilter() const { return first_row > 1 || last_row < kMaxExcelRow || !columns.isEmpty() || row_predicate; }
+    inline bool AcceptRow(int row) const { return row >= first_row && row <= last_row; }
+    inline bool AcceptColumn(int column) const { return columns.isEmpty() || columns.contains(column); }
+
+    // Keeps rows whose cell in column equals text.
+    // Shared string cells are compared by index, the string is looked up again only when the table changed.
+    static RowPredicate ColumnEquals(int column, const QString& text);
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_LOADOPTIONS_H
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_MEMORYFOOTPRINT_H
+#define YXLSX_MEMORYFOOTPRINT_H
+
+#include <QtGlobal>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// MemoryFootprint is the heap held by a workbook or a worksheet, in bytes.
+// - Sizes are allocated capacity plus array and allocator headers, not only the bytes in use.
+// - Implicitly shared Qt data is counted once per holder, so the figures err on the high side.
+struct MemoryFootprint {
+    qint64 cell_store {}; // rows and cells, values stored in the cell itself included
+    qint64 inline_string {}; // UTF-8 text of inline string cells
+    qint64 shared_string {}; // shared string tables: text, spans, index and reference counts
+    qint64 cached_part {}; // package parts kept after loading, e.g. a lazily decoded sharedStrings.xml
+
+    inline qint64 Total() const { return cell_store + inline_string + shared_string + cached_part; }
+
+    inline MemoryFootprint& operator+=(const MemoryFootprint& other)
+    {
+        cell_store += other.cell_store;
+        inline_string += other.inline_string;
+        shared_string += other.shared_string;
+        cached_part += other.cached_part;
+        return *this;
+    }
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_MEMORYFOOTPRINT_H
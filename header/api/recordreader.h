@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_RECORDREADER_H
+#define YXLSX_RECORDREADER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <concepts>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "generator.h"
+#include "loadoptions.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// Field maps a worksheet column (1-indexed) to a member of Record, e.g. Field { 3, &Entry::amount }.
+template <typename Record, typename Member> struct Field {
+    int column {};
+    Member Record::* member {};
+};
+
+template <typename Record, typename Member> Field(int, Member Record::*) -> Field<Record, Member>;
+
+// RecordError is a cell whose text could not be converted to the type of its field.
+struct RecordError {
+    int row {};
+    int column {};
+    CellType type { CellType::kNumber };
+    QString text {}; // the cell as tokenized, the index for a shared string
+};
+
+// RecordReaderBase reads the tokenized rows and converts single cells, RecordReader fills the fields.
+class RecordReaderBase {
+public:
+    inline const QList<RecordError>& GetError() const { return error_list_; }
+
+protected:
+    RecordReaderBase(QString xlsx_name, QString sheet_name, LoadOptions options);
+
+    const RawRow* NextRow();
+    void AddError(const RawRow& row, const RawCell& cell);
+
+    static bool Decode(const RawRow& row, const RawCell& cell, bool& value);
+    static bool Decode(const RawRow& row, const RawCell& cell, qint64& value);
+    static bool Decode(const RawRow& row, const RawCell& cell, double& value);
+    static bool Decode(const RawRow& row, const RawCell& cell, QString& value);
+    static bool Decode(const RawRow& row, const RawCell& cell, QByteArray& value);
+    static bool Decode(const RawRow& row, const RawCell& cell, QDateTime& value);
+
+private:
+    Generator<RawRow> row_generator_ {};
+    Generator<RawRow>::Iterator row_iterator_ {};
+    bool started_ { false };
+
+    QList<RecordError> error_list_ {};
+};
+
+// RecordReader decodes each row of a worksheet straight into a Record, following a schema of Fields.
+// - Cells are converted from their tokenized text, no QVariant or Cell is built.
+// - Supported members: bool, integral and floating point types, QString, QByteArray (UTF-8),
+//   QDateTime, and std::optional of any of them.
+// - A blank or missing cell leaves a member value-initialized (std::nullopt for an optional).
+// - A cell that does not convert is left the same way and reported by GetError(); reading goes on.
+// - Numbers are read from number cells and from strings holding a number; a date member also
+//   accepts an Excel serial date number.
+// - Only the schema's columns are tokenized, plus the columns of options' own column filter if it
+//   has one, e.g. for its row_predicate. A row_predicate without a column filter may look at any
+//   column, so then every column is tokenized.
+// - Serial date numbers follow Excel's 1900 date system, serial 60 (1900-02-29) is a conversion error.
+//
+//   RecordReader reader(path, "Sheet1", std::tuple { Field { 1, &Entry::date }, Field { 3, &Entry::amount } });
+//   Entry entry {};
+//   while (reader.Next(entry)) { ... }
+template <typename Record, typename... Members> class RecordReader final : public RecordReaderBase {
+public:
+    using Schema = std::tuple<Field<Record, Members>...>;
+
+    RecordReader(QString xlsx_name, QString sheet_name, Schema schema, LoadOptions options = {})
+        : RecordReaderBase(std::move(xlsx_name), std::move(sheet_name), WithColumns(schema, std::move(options)))
+        , schema_ { schema }
+    {
+    }
+
+    // Reads the next accepted row into record, returns false after the last one.
+    bool Next(Record& record)
+    {
+        const RawRow* row { NextRow() };
+        if (!row)
+            return false;
+
+        record = Record {};
+        std::apply([this, row, &record](const auto&... field) { (ReadField(*row, field, record), ...); }, schema_);
+        return true;
+    }
+
+private:
+    static LoadOptions WithColumns(const Schema& schema, LoadOptions options)
+    {
+        if (options.row_predicate && options.columns.isEmpty())
+            return options;
+
+        std::apply([&options](const auto&... field) { (options.columns.insert(field.column), ...); }, schema);
+        return options;
+    }
+
+    template <typename Member> void ReadField(const RawRow& row, const Field<Record, Member>& field, Record& record)
+    {
+        const RawCell* cell { row.Find(field.column) };
+        if (!cell || cell->IsEmpty())
+            return;
+
+        if (!ReadValue(row, *cell, record.*field.member))
+            AddError(row, *cell);
+    }
+
+    template <typename T> static bool ReadValue(const RawRow& row, const RawCell& cell, std::optional<T>& value)
+    {
+        T decoded {};
+        if (!ReadValue(row, cell, decoded))
+            return false;
+
+        value = std::move(decoded);
+        return true;
+    }
+
+    template <typename T> static bool ReadValue(const RawRow& row, const RawCell& cell, T& value)
+    {
+        if constexpr (std::same_as<T, bool> || std::same_as<T, double> || std::same_as<T, qint64> || std::same_as<T, QString>
+            || std::same_as<T, QByteArray> || std::same_as<T, QDateTime>) {
+            return Decode(row, cell, value);
+        } else if constexpr (std::is_integral_v<T>) {
+            qint64 decoded {};
+            if (!Decode(row, cell, decoded) || !std::in_range<T>(decoded))
+                return false;
+
+            value = static_cast<T>(decoded);
+            return true;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            double decoded {};
+            if (!Decode(row, cell, decoded))
+                return false;
+
+            value = static_cast<T>(decoded);
+            return true;
+        } else {
+            static_assert(sizeof(T) == 0, "RecordReader supports bool, arithmetic types, QString, QByteArray and QDateTime");
+        }
+    }
+
+private:
+    const Schema schema_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_RECORDREADER_H
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_STREAMROWS_H
+#define YXLSX_STREAMROWS_H
+
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+#include "cell.h"
+#include "generator.h"
+#include "loadoptions.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// StreamCell is one decoded cell of a streamed row; strings are returned as QString.
+struct StreamCell {
+    int column {};
+    CellType type { CellType::kNumber };
+    QVariant value {};
+};
+
+// StreamRow is one decoded <row>, holding only its non-empty cells in column order.
+struct StreamRow {
+    int row {};
+    QList<StreamCell> cells {};
+};
+
+// StreamRows yields the rows of one worksheet as the sheet xml is parsed, without building a Worksheet.
+// - Parsing advances only as the range is advanced; stopping early stops the parser.
+// - The yielded row is reused, it is valid until the next row is read; move from it to keep it.
+// - options filter rows and columns exactly as for Document; use_snapshot and row_index_stride are ignored.
+// - An unreadable file or an unknown sheet yields no rows.
+Generator<StreamRow> StreamRows(QString xlsx_name, QString sheet_name, LoadOptions options = {});
+
+// StreamRawRows yields the same rows tokenized but undecoded, for readers that convert the text themselves.
+// - RawRow::shared_string points to the file's table and is valid while the generator lives.
+Generator<RawRow> StreamRawRows(QString xlsx_name, QString sheet_name, LoadOptions options = {});
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_STREAMROWS_H
@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_TRACE_H
+#define YXLSX_TRACE_H
+
+#include <QString>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// Trace records spans of document operations as trace-event JSON, for Perfetto or chrome://tracing.
+// - Spans cover part parsing and composing, worksheet parsing and zip entry reads and writes,
+//   each with the part path and the thread it ran on.
+// - Spans are compiled in only if the library is built with ENABLE_TRACE; otherwise Start() fails.
+// - Compiled in but not started, a span costs one atomic load and a branch.
+// - A span still open when Stop() is called is not written, neither to this trace nor to the next.
+// - Start() begins recording, Stop() writes every span recorded since to the file given to Start().
+class Trace final {
+public:
+    static bool Start(const QString& file_path);
+    static bool Stop();
+    static bool IsCompiledIn();
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_TRACE_H
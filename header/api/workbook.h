@@ -39,8 +39,14 @@
 
 YXLSX_BEGIN_NAMESPACE
 
+// Order of the strings in xl/sharedStrings.xml after compaction.
+// - kFirstUse keeps the table order.
+// - kFrequency puts the most used strings first, so the common indices are the short ones.
+enum class StringOrder { kFirstUse, kFrequency };
+
 class Workbook final : public AbstractOOXmlFile {
     Q_DISABLE_COPY_MOVE(Workbook)
+    friend class Snapshot;
 
 public:
     explicit Workbook(OperationMode mode);
@@ -66,10 +72,17 @@ public:
     int GetSheetCount() const { return sheet_list_.count(); }
 
     QSharedPointer<SharedString> GetSharedString() const { return shared_string_; }
+    void SetSharedStringOrder(StringOrder order) { shared_string_order_ = order; }
+    void CompactSharedString();
+    void SetParallelWrite(bool enable);
+    bool IsParallelWrite() const { return parallel_write_; }
     QSharedPointer<Style> GetStyle() { return style_; }
     QSharedPointer<Theme> GetTheme() { return theme_; }
     QList<QSharedPointer<AbstractSheet>> GetSheetByType(SheetType type) const;
 
+    // Heap held by every worksheet and shared string table of the workbook, see MemoryFootprint.
+    MemoryFootprint MemoryUsage() const;
+
 private:
     void ComposeXml(QIODevice* device) const override;
 
@@ -92,6 +105,7 @@ private:
     QString GetXmlAttribute(const QXmlStreamAttributes& attrs, QAnyStringView key) { return attrs.hasAttribute(key) ? attrs.value(key).toString() : QString(); }
     QString ResolveFullPath(const QString& target, const QString& base_path) const;
 
+    QSharedPointer<SharedString> CreateSheetSharedString() const;
     QSharedPointer<AbstractSheet> LoadSheet(const QString& name, int sheet_id, SheetType type = SheetType::kWorkSheet);
 
 private:
@@ -109,6 +123,8 @@ private:
     int window_height_ {};
 
     int current_sheet_index_ {};
+    StringOrder shared_string_order_ { StringOrder::kFirstUse };
+    bool parallel_write_ { false };
 
     // Used to generate new sheet name and id
     int last_sheet_index_ {};
@@ -25,13 +25,28 @@
 #ifndef YXLSX_WORKSHEET_H
 #define YXLSX_WORKSHEET_H
 
+#include <QBitArray>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
+#include <algorithm>
+#include <concepts>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <type_traits>
 
 #include "abstractsheet.h"
 #include "cell.h"
+#include "cellref.h"
+#include "cellstore.h"
 #include "coordinate.h"
 #include "dimension.h"
+#include "loadoptions.h"
+#include "memoryfootprint.h"
 #include "namespace.h"
 #include "sharedstring.h"
 #include "sheetformatprops.h"
@@ -45,129 +60,285 @@ concept Container = std::ranges::range<T> && requires(T t) {
     requires std::convertible_to<std::ranges::range_value_t<T>, QVariant>;
 };
 
+// Element types WriteRow() and WriteColumn() store without building a QVariant first: the standard
+// integer types, float and double. Character types and long double, which QVariant has no
+// number type for, are left out.
+template <typename T>
+concept NumberValue = std::same_as<T, short> || std::same_as<T, unsigned short> || std::same_as<T, int> || std::same_as<T, unsigned int>
+    || std::same_as<T, long> || std::same_as<T, unsigned long> || std::same_as<T, long long> || std::same_as<T, unsigned long long>
+    || std::same_as<T, float> || std::same_as<T, double>;
+
+template <typename T>
+concept StringValue = std::convertible_to<const T&, QStringView>;
+
+// Element types Write() stores directly, see WriteValue().
+template <typename T>
+concept TypedValue = std::same_as<T, bool> || NumberValue<T> || StringValue<T> || std::same_as<T, QDateTime>;
+
+template <typename T>
+concept OptionalValue = std::same_as<T, std::optional<typename T::value_type>>;
+
 class Worksheet final : public AbstractSheet {
+    friend class CellRef;
+    friend class Snapshot;
+    friend class Workbook;
+
 public:
     Worksheet(const QString& sheet_name, int sheet_id, const QSharedPointer<SharedString>& shared_strings, SheetType sheet_type);
     ~Worksheet() override;
 
 public:
+    // With LoadOptions::lazy_shared_string the first read of a shared string decodes it into the
+    // workbook's table, so reads of one workbook must not run on several threads at once.
     QVariant Read(const Coordinate& coordinate) const;
     QVariant Read(int row, int column) const;
 
     bool Write(const Coordinate& coordinate, const QVariant& data, StringType string_type = StringType::kSharedString);
     bool Write(int row, int column, const QVariant& data, StringType string_type = StringType::kSharedString);
+    bool Write(const Coordinate& coordinate, QVariant&& data, StringType string_type = StringType::kSharedString);
+    bool Write(int row, int column, QVariant&& data, StringType string_type = StringType::kSharedString);
 
-    template <Container T> inline bool WriteColumn(int row, int column, const T& container, StringType string_type = StringType::kSharedString)
+    // Typed writes store the value without building a QVariant first, the cell type is picked at compile time.
+    // Strings are interned from a view, a QString argument is never copied.
+    template <TypedValue V> inline bool Write(int row, int column, const V& value, StringType string_type = StringType::kSharedString)
     {
-        if (container.size() == 0 || !Utility::IsValidRowColumn(row, column)) {
-            qWarning() << "Data is empty for column write.";
+        if (!UpdateDimension(row, column))
             return false;
-        }
 
-        int end_row = row + container.size() - 1;
-        if (!UpdateDimension(row, column) || !UpdateDimension(end_row, column)) {
-            qWarning() << "Failed to update dimensions for column write.";
+        matrix_.WriteRows(row, 1, [&](int, CellStore::RowWriter& writer) { WriteValue(writer, row, column, value, string_type); });
+        return true;
+    }
+
+    template <TypedValue V> inline bool Write(const Coordinate& coordinate, const V& value, StringType string_type = StringType::kSharedString)
+    {
+        return coordinate.IsValid() && Write(coordinate.Row(), coordinate.Column(), value, string_type);
+    }
+
+    template <Container T> inline bool WriteColumn(int row, int column, const T& container, StringType string_type = StringType::kSharedString)
+    {
+        if (!PrepareColumn(row, column, static_cast<qsizetype>(container.size())))
             return false;
-        }
 
-        int current_row { row };
-        for (const auto& value : container) {
-            QVariant qvalue(value);
+        auto it { container.begin() };
+        matrix_.WriteRows(row, static_cast<int>(container.size()), [&](int current_row, CellStore::RowWriter& writer) {
+            WriteValue(writer, current_row, column, *it, string_type);
+            ++it;
+        });
 
-            const CellType cell_type { DetermineCellType(qvalue, string_type) };
+        return true;
+    }
 
-            if (cell_type != CellType::kEmpty) {
-                auto cell { QSharedPointer<Cell>::create(qvalue, cell_type) };
+    template <Container T> inline bool WriteRow(int row, int column, const T& container, StringType string_type = StringType::kSharedString)
+    {
+        if (!PrepareRange(row, column, 1, static_cast<int>(container.size())))
+            return false;
 
-                if (cell_type == CellType::kSharedString) {
-                    shared_string_->SetSharedString(qvalue.toString());
-                }
+        matrix_.WriteRows(row, 1, [&](int, CellStore::RowWriter& writer) {
+            int current_column { column };
+            for (const auto& value : container) {
+                WriteValue(writer, row, current_column, value, string_type);
 
-                WriteMatrix(current_row, column, cell);
+                ++current_column;
             }
-
-            ++current_row;
-        }
+        });
 
         return true;
     }
 
-    template <Container T> inline bool WriteRow(int row, int column, const T& container, StringType string_type = StringType::kSharedString)
+    // Bulk column writes from contiguous buffers, values[i] goes to (row + i, column).
+    // A set bit i in nulls leaves that cell unwritten. The dimension is extended once per call,
+    // and the rows are merged into the sheet in one pass, see CellStore::WriteRows().
+    bool WriteColumnSpan(int row, int column, std::span<const double> values, const QBitArray& nulls = {});
+    bool WriteColumnSpan(int row, int column, std::span<const qint64> values, const QBitArray& nulls = {});
+    bool WriteColumnSpan(
+        int row, int column, std::span<const QStringView> values, const QBitArray& nulls = {}, StringType string_type = StringType::kSharedString);
+
+    // Writes one row per record down from (row, column), one column per member of fields, in order.
+    // - fields is a tuple of member pointers, e.g. std::tuple { &Entry::date, &Entry::account, &Entry::amount }.
+    // - Each member is stored as WriteRow() would store it, the cell type is picked at compile time.
+    // - An empty std::optional member leaves its cell unwritten.
+    // - The dimension is extended once per call, the rows are merged into the sheet in one pass.
+    template <std::ranges::sized_range R, typename... Fields>
+        requires(sizeof...(Fields) > 0 && (std::is_member_object_pointer_v<Fields> && ...))
+    bool WriteRecords(int row, int column, const R& records, const std::tuple<Fields...>& fields, StringType string_type = StringType::kSharedString)
     {
-        if (container.size() == 0 || !Utility::IsValidRowColumn(row, column)) {
-            qWarning() << "Data is empty for row write.";
+        if (!PrepareRange(row, column, static_cast<qsizetype>(std::ranges::size(records)), static_cast<int>(sizeof...(Fields))))
             return false;
-        }
 
-        int end_column = column + container.size() - 1;
-        if (!UpdateDimension(row, column) || !UpdateDimension(row, end_column)) {
-            qWarning() << "Failed to update dimensions for row write.";
-            return false;
-        }
+        auto it { std::ranges::begin(records) };
+        matrix_.WriteRows(row, static_cast<int>(std::ranges::size(records)), [&](int current_row, CellStore::RowWriter& writer) {
+            const auto& record { *it };
+            std::apply(
+                [&](const auto&... field) {
+                    int current_column { column };
+                    (WriteField(writer, current_row, current_column++, record.*field, string_type), ...);
+                },
+                fields);
 
-        int current_column { column };
-        for (const auto& value : container) {
-            QVariant qvalue(value);
+            ++it;
+        });
 
-            const CellType cell_type { DetermineCellType(qvalue, string_type) };
+        return true;
+    }
+
+    // Non-empty rows in order, see RowRef and CellRef. Runs in time proportional to the stored rows and cells.
+    inline auto Rows() const
+    {
+        return matrix_ | std::views::transform([this](const CellStore::RowEntry& entry) { return RowRef(entry.row, entry.entry_list, shared_string_.data()); });
+    }
 
-            if (cell_type != CellType::kEmpty) {
-                auto cell { QSharedPointer<Cell>::create(qvalue, cell_type) };
+    // Typed bulk reads into caller buffers, cells are visited in storage order.
+    // - ReadRange fills values row-major for range, it must hold RowCount() * ColumnCount() elements.
+    // - valid is resized to values.size(), bit i is set if values[i] was read from a cell.
+    // - Arithmetic types read number and boolean cells, bool reads boolean cells,
+    //   QString reads any cell as Read() would.
+    template <typename T> bool ReadRange(const Dimension& range, std::span<T> values, QBitArray& valid) const
+    {
+        const qsizetype width { range.ColumnCount() };
+        if (!range.IsValid() || static_cast<qsizetype>(values.size()) < range.RowCount() * width)
+            return false;
 
-                if (cell_type == CellType::kSharedString) {
-                    shared_string_->SetSharedString(qvalue.toString());
-                }
+        valid.fill(false, static_cast<qsizetype>(values.size()));
 
-                WriteMatrix(row, current_column, cell);
-            }
+        for (auto row_it { matrix_.LowerBound(range.TopRow()) }; row_it != matrix_.end() && row_it->row <= range.BottomRow(); ++row_it) {
+            const auto& entry_list { row_it->entry_list };
+            const qsizetype base { (row_it->row - range.TopRow()) * width };
 
-            ++current_column;
+            auto it { std::lower_bound(entry_list.cbegin(), entry_list.cend(), range.LeftColumn(),
+                [](const CellStore::Entry& entry, int column) { return entry.column < column; }) };
+
+            for (; it != entry_list.cend() && it->column <= range.RightColumn(); ++it) {
+                const qsizetype index { base + it->column - range.LeftColumn() };
+                if (ReadCellAs(it->cell, values[index]))
+                    valid.setBit(index);
+            }
         }
 
         return true;
     }
 
+    // Reads values.size() cells of column down from first_row.
+    template <typename T> bool ReadColumn(int column, int first_row, std::span<T> values, QBitArray& valid) const
+    {
+        if (values.empty())
+            return false;
+
+        return ReadRange(Dimension(first_row, column, first_row + static_cast<int>(values.size()) - 1, column), values, valid);
+    }
+
+    inline void SetLoadOptions(const LoadOptions& options) { load_options_ = options; }
+
+    // Adds the number of stored cells of each type to count_hash.
+    void CountCellType(QHash<CellType, qint64>& count_hash) const;
+
+    // Heap held by the cells of this sheet. The shared string table is counted by Workbook::MemoryUsage().
+    MemoryFootprint MemoryUsage() const;
+
 private:
     void ComposeXml(QIODevice* device) const override;
     bool ParseXml(QIODevice* device) override;
-    void ProcessCell(QXmlStreamReader& reader);
-    QVariant ParseCellValue(const QString& value, CellType cell_type);
 
     bool UpdateDimension(int row, int col);
     QString ComposeDimension() const;
 
     void ComposeSheet(QXmlStreamWriter& writer) const;
-    void ComposeCell(QXmlStreamWriter& writer, int row, int col, const QSharedPointer<Cell>& cell) const;
 
-    void ParseSheet(QXmlStreamReader& reader);
-    void ParseRow(QXmlStreamReader& reader);
+    void StoreRow(const RawRow& row);
 
-    inline void WriteMatrix(int row, int column, const QSharedPointer<Cell>& cell) { matrix_[row][column] = cell; }
-    inline QSharedPointer<Cell> ReadMatrix(int row, int column) const
+    void WriteMatrix(int row, int column, Cell cell);
+    void StoreCell(CellStore::RowWriter& writer, int column, Cell cell);
+    void WriteCell(CellStore::RowWriter& writer, int row, int column, QVariant value, StringType string_type);
+    void WriteString(CellStore::RowWriter& writer, int row, int column, QStringView text, StringType string_type);
+    bool PrepareRange(int row, int column, qsizetype row_count, int column_count);
+    inline bool PrepareColumn(int row, int column, qsizetype count) { return PrepareRange(row, column, count, 1); }
+
+    // Dispatches on the element type at compile time, only other types go through WriteCell().
+    // writer is the stored row of a CellStore::WriteRows() block holding row.
+    template <typename V> inline void WriteValue(CellStore::RowWriter& writer, int row, int column, const V& value, StringType string_type)
     {
-        auto it = matrix_.constFind(row);
-        if (it == matrix_.constEnd())
-            return {};
+        if constexpr (std::same_as<V, bool>)
+            StoreCell(writer, column, Cell { QVariant(value), CellType::kBoolean });
+        else if constexpr (NumberValue<V>)
+            StoreCell(writer, column, Cell { QVariant::fromValue(value), CellType::kNumber });
+        else if constexpr (StringValue<V>)
+            WriteString(writer, row, column, QStringView(value), string_type);
+        else if constexpr (std::same_as<V, QDateTime>)
+            StoreCell(writer, column, Cell { QVariant(value), CellType::kDateTime });
+        else
+            WriteCell(writer, row, column, QVariant(value), string_type);
+    }
 
-        return it->value(column);
+    template <typename V> inline void WriteField(CellStore::RowWriter& writer, int row, int column, const V& value, StringType string_type)
+    {
+        if constexpr (OptionalValue<V>) {
+            if (value)
+                WriteValue(writer, row, column, *value, string_type);
+        } else {
+            WriteValue(writer, row, column, value, string_type);
+        }
     }
-    inline bool Contains(int row, int column) const
+
+    inline const Cell* ReadMatrix(int row, int column) const { return matrix_.Read(row, column); }
+    inline QVariant ReadCell(const Cell& cell) const { return ReadCell(cell, shared_string_.data()); }
+    static QVariant ReadCell(const Cell& cell, const SharedString* shared_string);
+
+    template <typename T> inline bool ReadCellAs(const Cell& cell, T& value) const
     {
-        auto it = matrix_.constFind(row);
-        if (it == matrix_.constEnd())
+        if (!cell.value.isValid())
             return false;
 
-        return it->contains(column);
+        if constexpr (std::same_as<T, bool>) {
+            if (cell.type != CellType::kBoolean)
+                return false;
+
+            value = cell.value.toBool();
+        } else if constexpr (std::is_integral_v<T>) {
+            if (cell.type != CellType::kNumber && cell.type != CellType::kBoolean)
+                return false;
+
+            value = static_cast<T>(cell.value.toLongLong());
+        } else if constexpr (std::is_floating_point_v<T>) {
+            if (cell.type != CellType::kNumber && cell.type != CellType::kBoolean)
+                return false;
+
+            value = static_cast<T>(cell.value.toDouble());
+        } else if constexpr (std::same_as<T, QString>) {
+            value = ReadCell(cell).toString();
+        } else {
+            static_assert(sizeof(T) == 0, "ReadRange supports arithmetic types and QString");
+        }
+
+        return true;
     }
+    inline bool Contains(int row, int column) const { return matrix_.Contains(row, column); }
 
     bool WriteBlank(int row, int column);
-    CellType DetermineCellType(const QVariant& value, StringType string_type = StringType::kSharedString) const;
+
+    void CountSharedString(QList<int>& count_list) const;
+    void RemapSharedString(const QList<int>& remap);
+
+    StringType GetAutoStringType(int column) const;
+    void SampleAutoString(int row, int column, int index);
+    void InlineAutoString(int column, const QList<std::pair<int, int>>& cell_list);
+    void ResolveAutoString();
+
+private:
+    // Strings written with StringType::kAuto to one column, sampled until the column is decided.
+    struct AutoStringColumn {
+        QSet<int> sample {}; // distinct shared string indices
+        QList<std::pair<int, int>> cell_list {}; // row and shared string index of each sampled cell
+        int sample_count {};
+        StringType type { StringType::kAuto }; // kAuto until decided
+    };
 
 private:
     Dimension dimension_ {};
     QSharedPointer<SharedString> shared_string_ {};
     SheetFormatProps sheet_format_props_ {};
-    QMap<int, QMap<int, QSharedPointer<Cell>>> matrix_ {};
+    LoadOptions load_options_ {};
+    RawRow raw_row_ {}; // reused for every parsed row
+    CellStore matrix_ {};
+    QHash<int, AutoStringColumn> auto_string_hash_ {}; // column -> sample
 };
 
 YXLSX_END_NAMESPACE
@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_CELLCODEC_H
+#define YXLSX_CELLCODEC_H
+
+#include <QVariant>
+#include <QXmlStreamWriter>
+
+#include "cell.h"
+#include "loadoptions.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+class SharedString;
+
+// CellCodec converts single cells between values and sheet xml, the per-cell work of Worksheet.
+// - DetermineCellType() picks the cell type a written value is stored as.
+// - ParseCellValue() decodes a loaded cell, a shared string cell takes a reference and an inline
+//   string keeps the UTF-8 bytes the reader handed over.
+// - ComposeCell() writes one <c> element.
+// The functions hold no state, so benchmark/microbench.cc times them directly.
+class CellCodec final {
+public:
+    static CellType DetermineCellType(const QVariant& value, StringType string_type = StringType::kSharedString);
+    static QVariant ParseCellValue(const RawCell& cell, SharedString* shared_string);
+    static void ComposeCell(QXmlStreamWriter& writer, int row, int column, const Cell& cell, const SharedString* shared_string);
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_CELLCODEC_H
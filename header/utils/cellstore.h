@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_CELLSTORE_H
+#define YXLSX_CELLSTORE_H
+
+#include <QList>
+#include <utility>
+
+#include "cell.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// CellStore keeps the cells of a worksheet, row by row.
+// - Only rows holding a cell are stored, sorted by row number; writing in row order appends.
+// - Each row holds its cells by value, sorted by column; writing in column order appends.
+// - Reserve() is only a capacity hint, e.g. from the <dimension> of a loaded sheet.
+// - WriteRows() writes a block of rows with one pass over the row list for the whole block.
+// - Iterating the store visits the stored rows in order, none of them is empty.
+class CellStore final {
+public:
+    struct Entry {
+        int column {};
+        Cell cell {};
+    };
+
+    using Row = QList<Entry>;
+
+    struct RowEntry {
+        int row {};
+        Row entry_list {};
+    };
+
+    // Writes the cells of one row of a WriteRows() block, as Write() does.
+    class RowWriter {
+    public:
+        inline void Write(int column, Cell cell, Cell* replaced = nullptr) { store_.WriteEntry(entry_list_, column, std::move(cell), replaced); }
+
+    private:
+        friend class CellStore;
+        inline RowWriter(CellStore& store, Row& entry_list)
+            : store_ { store }
+            , entry_list_ { entry_list }
+        {
+        }
+
+        CellStore& store_;
+        Row& entry_list_;
+    };
+
+    void Reserve(int row_count, int column_count);
+    void Write(int row, int column, Cell cell, Cell* replaced = nullptr);
+
+    // Writes the block of row_count rows from row: the rows missing from the block are merged
+    // into the row list at once, then fill(row, writer) is called for each row in order.
+    // fill must write through writer only. Rows of the block left empty are dropped afterwards.
+    template <typename F> void WriteRows(int row, int row_count, F&& fill)
+    {
+        Q_ASSERT(row >= 1 && row_count >= 0);
+
+        const qsizetype first { InsertRows(row, row_count) };
+        for (int offset = 0; offset != row_count; ++offset) {
+            RowWriter writer { *this, row_list_[first + offset].entry_list };
+            fill(row + offset, writer);
+        }
+
+        DropEmptyRows(first, row_count);
+    }
+
+    const Cell* Read(int row, int column) const;
+    inline Cell* Read(int row, int column) { return const_cast<Cell*>(std::as_const(*this).Read(row, column)); }
+    inline bool Contains(int row, int column) const { return Read(row, column) != nullptr; }
+
+    // Rows are 1-indexed, LastRow() is 0 for an empty store.
+    inline int LastRow() const { return row_list_.isEmpty() ? 0 : row_list_.constLast().row; }
+    inline qsizetype RowCount() const { return row_list_.size(); }
+    inline qsizetype CellCount() const { return cell_count_; }
+
+    // First stored row at or after row.
+    QList<RowEntry>::const_iterator LowerBound(int row) const;
+
+    inline auto begin() const { return row_list_.cbegin(); }
+    inline auto end() const { return row_list_.cend(); }
+    inline auto begin() { return row_list_.begin(); }
+    inline auto end() { return row_list_.end(); }
+
+    // Heap bytes of the row list and the cells, values held outside a cell are not included.
+    qint64 MemoryUsage() const;
+
+private:
+    QList<RowEntry>::iterator FindOrInsertRow(int row);
+    qsizetype InsertRows(int row, int row_count);
+    void DropEmptyRows(qsizetype first, int row_count);
+    void WriteEntry(Row& entry_list, int column, Cell cell, Cell* replaced);
+
+private:
+    QList<RowEntry> row_list_ {}; // sorted by row
+    qsizetype column_reserve_ {};
+    qsizetype cell_count_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+Q_DECLARE_TYPEINFO(yxlsx::CellStore::Entry, Q_RELOCATABLE_TYPE);
+Q_DECLARE_TYPEINFO(yxlsx::CellStore::RowEntry, Q_RELOCATABLE_TYPE);
+
+#endif // YXLSX_CELLSTORE_H
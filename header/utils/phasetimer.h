@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_PHASETIMER_H
+#define YXLSX_PHASETIMER_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include "documentstats.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// PhaseTimer records the wall and thread CPU time of its scope as one PhaseStats.
+// - With a null stats it only holds its arguments, no clock is read.
+class PhaseTimer final {
+    Q_DISABLE_COPY(PhaseTimer)
+
+public:
+    PhaseTimer(DocumentStats* stats, QString phase, QString part = {});
+    ~PhaseTimer();
+
+    inline void SetBytes(qint64 bytes) { bytes_ = bytes; }
+
+private:
+    static qint64 ThreadCpuNs();
+
+private:
+    DocumentStats* stats_ {};
+    QString phase_ {};
+    QString part_ {};
+    QElapsedTimer timer_ {};
+    qint64 cpu_start_ns_ {};
+    qint64 bytes_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_PHASETIMER_H
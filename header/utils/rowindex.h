@@ -0,0 +1,77 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_ROWINDEX_H
+#define YXLSX_ROWINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// RowIndex records where every Nth <row> starts in the uncompressed xml of a worksheet.
+// - It is built by a byte scan of the sheet xml during the first full load.
+// - It is keyed by the CRC-32 and uncompressed size of the zip entry and by the stride,
+//   a changed sheet or stride invalidates it.
+// - Seek() returns the sheet xml with the rows before the target cut out, so the parser starts close to it.
+// QZipReader inflates whole entries, so the index saves the xml parse, not the inflate.
+class RowIndex final {
+public:
+    struct Entry {
+        int row {};
+        qsizetype offset {}; // offset of "<row" in the uncompressed xml
+    };
+
+    RowIndex() = default;
+
+    bool Build(const QByteArray& xml, quint32 crc, int stride);
+    QByteArray Seek(const QByteArray& xml, int row) const;
+
+    // An index built with another stride is rebuilt, so changing LoadOptions::row_index_stride takes effect.
+    inline bool Matches(quint32 crc, qsizetype size, int stride) const { return crc_ == crc && size_ == size && stride_ == stride && !entry_list_.isEmpty(); }
+
+    // The sidecar file holds the indexes of all worksheets of a document, keyed by xml path.
+    static QString SidecarPath(const QString& xlsx_name) { return xlsx_name + QStringLiteral(".rowindex"); }
+    static QHash<QString, RowIndex> Load(const QString& sidecar_path);
+    static bool Save(const QString& sidecar_path, const QHash<QString, RowIndex>& index_hash);
+
+private:
+    static int ParseRowNumber(const QByteArray& xml, qsizetype begin, qsizetype end);
+
+private:
+    quint32 crc_ {};
+    qsizetype size_ {};
+    qsizetype sheet_data_offset_ {}; // first byte after the <sheetData> start tag
+    int stride_ {};
+    QList<Entry> entry_list_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+Q_DECLARE_TYPEINFO(yxlsx::RowIndex::Entry, Q_PRIMITIVE_TYPE);
+
+#endif // YXLSX_ROWINDEX_H
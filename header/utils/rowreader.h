@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_ROWREADER_H
+#define YXLSX_ROWREADER_H
+
+#include <QIODevice>
+#include <QVariant>
+#include <QXmlStreamReader>
+
+#include "dimension.h"
+#include "loadoptions.h"
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+class SharedString;
+
+// RowReader tokenizes the rows of a worksheet part one at a time.
+// - ReadHeader() reads up to <sheetData>, picking up <dimension> on the way.
+// - ReadRow() fills a RawRow with the next row the LoadOptions accept, the values stay undecoded.
+// - Worksheet stores the rows it reads, StreamRows() hands them out as they are read.
+class RowReader final {
+public:
+    RowReader(QIODevice* device, const LoadOptions& options, const SharedString* shared_string);
+
+    bool ReadHeader();
+    bool ReadRow(RawRow& row);
+
+    inline const Dimension& GetDimension() const { return dimension_; }
+    inline bool HasError() const { return reader_.hasError(); }
+    inline QString ErrorString() const { return reader_.errorString(); }
+
+    static QVariant ParseValue(const QString& text, CellType type);
+
+private:
+    enum class RowResult { kAccepted, kSkipped, kPastEnd };
+
+    RowResult ParseRow(RawRow& row);
+    void ProcessCell(RawRow& row);
+    QByteArray ReadElementUtf8();
+
+private:
+    QXmlStreamReader reader_ {};
+    LoadOptions options_ {};
+    const SharedString* shared_string_ {};
+    Dimension dimension_ {};
+    bool done_ { false };
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_ROWREADER_H
@@ -25,57 +25,151 @@
 #ifndef YXLSX_SHAREDSTRING_H
 #define YXLSX_SHAREDSTRING_H
 
-#include <QHash>
+#include <QByteArray>
 #include <QIODevice>
 #include <QList>
-#include <QSet>
+#include <QSharedPointer>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
 #include "abstractooxmlfile.h"
+#include "memoryfootprint.h"
 #include "namespace.h"
 
 YXLSX_BEGIN_NAMESPACE
 
 class SharedString final : public AbstractOOXmlFile {
+    friend class Snapshot;
+
 public:
     explicit SharedString(OperationMode mode);
 
-    void SetSharedString(const QString& string);
+    // A copy has a generation of its own.
+    SharedString(const SharedString& other);
+    SharedString& operator=(const SharedString& other);
+
+    // An overlay on base for a worksheet written in parallel: indices below the size of base
+    // read from base, which must not change while the overlay lives; new strings are kept here
+    // and numbered after them. References to strings of base are not counted, Merge() takes
+    // the counts from the cells.
+    explicit SharedString(const QSharedPointer<SharedString>& base);
+
+    int SetSharedString(QStringView string);
     void IncrementReference(int index);
+    void DecrementReference(int index);
 
-    inline int GetSharedStringIndex(const QString& string) const { return string_index_hash_.value(string, -1); }
-    inline bool IsEmpty() const { return string_list_.isEmpty(); }
+    // On a lazily loaded table this is a linear scan that decodes items until the string is found,
+    // the index is only built once the table is written to.
+    int GetSharedStringIndex(QStringView string) const;
+    inline bool IsEmpty() const { return Count() == 0; }
 
+    // Changes when the table is loaded, swapped or renumbered, and is never shared by two tables,
+    // a copy draws its own. Adding a string keeps it, so an index looked up in the table stays
+    // valid while the generation and Count() are the same.
+    inline quint64 Generation() const { return generation_; }
+    inline qsizetype Count() const { return base_count_ + span_list_.size(); }
+
+    // On a lazily loaded table the getters are not read-only: the first read of a string decodes it
+    // and appends it to the arena, so two threads reading the same const table race, and the
+    // arena may move under views handed out earlier.
     QString GetSharedString(int index) const;
+    QByteArray GetSharedStringUtf8(int index) const;
+
+    // UTF-8 view of the string at index, valid until the table is modified or, on a lazily loaded
+    // table, until the next string that is not decoded yet is read.
+    inline QByteArrayView GetSharedStringView(int index) const
+    {
+        if (index < base_count_)
+            return index >= 0 ? base_->GetView(index) : QByteArrayView();
+
+        index -= base_count_;
+        return index < span_list_.size() ? GetView(index) : QByteArrayView();
+    }
+
+    QList<int> Compact(const QList<int>& count_list, bool order_by_frequency);
+    QList<int> Merge(const SharedString& source, const QList<int>& count_list, bool order_by_frequency);
+    void Swap(SharedString& other);
+
+    inline void SetLazy(bool lazy) { lazy_ = lazy; }
+
+    // Fills shared_string with the table and cached_part with the part kept for lazy decoding.
+    MemoryFootprint MemoryUsage() const;
 
     void ComposeXml(QIODevice* device) const override;
     bool ParseXml(QIODevice* device) override;
+    bool ParseByteArray(const QByteArray& data) override;
 
 private:
+    struct Span {
+        qsizetype offset {};
+        qsizetype size {};
+    };
+
+    struct Slot {
+        size_t hash {};
+        int index { -1 };
+    };
+
     void ParseSharedString(QXmlStreamReader& reader); // <si>
+    static QString ReadItem(QXmlStreamReader& reader);
+    static bool ReadPlainItem(QByteArrayView xml, QByteArrayView& text);
+
+    bool ScanXml(const QByteArray& data);
+    void Decode(int index) const;
+    void DecodeAll() const;
+    void Materialize();
+
+    void Reserve(qsizetype count);
+    int Intern(QByteArrayView string);
+    int Append(QByteArrayView string);
+    int Insert(QByteArrayView string, size_t hash, qsizetype slot);
+    qsizetype FindSlot(QByteArrayView string, size_t hash) const;
+    void Rehash(qsizetype capacity);
+    void RebuildIndex();
+
+    // UTF-8 bytes of the string at index, valid until the arena grows.
+    inline QByteArrayView GetView(int index) const
+    {
+        if (span_list_.at(index).offset < 0)
+            Decode(index);
+
+        return QByteArrayView(arena_).sliced(span_list_.at(index).offset, span_list_.at(index).size);
+    }
 
 private:
     /**
-     * @brief Simulates the shared strings in the filename.xlsx/xl/sharedStrings.xml file.
+     * @brief Every shared string, stored once and back to back in UTF-8.
      *
-     * @details This list determines the order and indices of shared strings in the table.
-     * Each string is stored in sequence, and the index corresponds to its position.
-     *
-     * @note This structure is critical for XML-based Excel file parsing.
+     * @details The order of span_list_ is the order of the <si> items in xl/sharedStrings.xml,
+     * the position of a span is the index cells refer to. A lazily loaded item has a negative
+     * offset until it is decoded. Decoding appends to the arena from const getters, which may
+     * reallocate it, see GetSharedStringView().
      */
-    QList<QString> string_list_ {};
+    mutable QByteArray arena_ {};
+    mutable QList<Span> span_list_ {};
+
+    // Lazy load: the part and the byte offset of each <si>, followed by the end of the last one.
+    bool lazy_ { false };
+    QByteArray lazy_source_ {};
+    QList<qsizetype> lazy_offset_list_ {};
 
     /**
-     * @brief string_index_hash_
+     * @brief Open addressing index from string to its position in span_list_.
      *
-     * Maintains a mapping between shared strings and their corresponding indices
-     * in the shared string table (`string_list_`). This allows efficient lookup
-     * of a string's index when inserting or referencing shared strings.
+     * @details Linear probing over a power of two table kept at most half full. Each slot keeps
+     * the full hash, so probing compares strings only when the hashes match.
      */
-    QHash<QString, int> string_index_hash_ {};
+    QList<Slot> slot_list_ {};
+    qsizetype slot_used_ {}; // less than span_list_.size() if the loaded table has duplicates
+
+    // Reference count of each shared string, parallel to span_list_.
+    QList<int> reference_list_ {};
+
+    // Overlay: the table the first base_count_ indices refer to, span_list_ holds the rest.
+    QSharedPointer<SharedString> base_ {};
+    int base_count_ {};
 
-    QHash<QString, int> string_count_hash_ {};
+    quint64 generation_ {};
 };
 
 YXLSX_END_NAMESPACE
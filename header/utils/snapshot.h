@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_SNAPSHOT_H
+#define YXLSX_SNAPSHOT_H
+
+#include <QDataStream>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+class Document;
+class Workbook;
+class Worksheet;
+
+// Snapshot caches a fully loaded document in a binary file next to the xlsx.
+// - It holds the document properties, the shared string table and every worksheet's cells.
+// - It is keyed by the size, mtime and a hash of the zip central directory of the source file.
+// - Loading maps the snapshot and rebuilds the workbook from it, with no inflate and no xml parse.
+// - A stale, truncated or foreign snapshot is ignored and rewritten by the next full load.
+class Snapshot final {
+public:
+    static QString SnapshotPath(const QString& xlsx_name) { return xlsx_name + QStringLiteral(".snapshot"); }
+
+    static bool Load(const QString& xlsx_name, Document& document);
+    static bool Save(const QString& xlsx_name, const Document& document);
+
+private:
+    static QByteArray Fingerprint(const QString& xlsx_name);
+
+    static bool LoadDocument(QDataStream& stream, const QString& xlsx_name, Document& document);
+    static void SaveWorkbook(QDataStream& stream, const Workbook& workbook);
+    static bool LoadWorkbook(QDataStream& stream, Workbook& workbook);
+    static void SaveWorksheet(QDataStream& stream, const Worksheet& sheet);
+    static bool LoadWorksheet(QDataStream& stream, Worksheet& sheet);
+};
+
+YXLSX_END_NAMESPACE
+
+#endif // YXLSX_SNAPSHOT_H
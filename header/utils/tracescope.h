@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef YXLSX_TRACESCOPE_H
+#define YXLSX_TRACESCOPE_H
+
+#include <QString>
+#include <atomic>
+
+#include "namespace.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+// TraceRecorder collects the spans of an active Trace, see trace.h.
+// - Each Start() begins a new generation, 0 means no trace is running.
+// - A span keeps the generation it started in and is dropped if it ends in another one,
+//   so a span open across Stop() and Start() never lands in the next trace.
+class TraceRecorder final {
+public:
+    static inline quint64 Generation() { return generation_.load(std::memory_order_acquire); }
+    static inline bool IsActive() { return Generation() != 0; }
+
+    static qint64 NowNs();
+    static void Record(const char* name, const QString& part, quint64 generation, qint64 start_ns, qint64 end_ns);
+
+private:
+    friend class Trace;
+    static inline std::atomic<quint64> generation_ { 0 };
+};
+
+// TraceScope records its lifetime as one span while a trace is active.
+class TraceScope final {
+    Q_DISABLE_COPY(TraceScope)
+
+public:
+    inline TraceScope(const char* name, const QString& part)
+        : name_ { name }
+        , generation_ { TraceRecorder::Generation() }
+    {
+        if (generation_ == 0)
+            return;
+
+        part_ = part;
+        start_ns_ = TraceRecorder::NowNs();
+    }
+
+    inline ~TraceScope()
+    {
+        if (generation_ != 0)
+            TraceRecorder::Record(name_, part_, generation_, start_ns_, TraceRecorder::NowNs());
+    }
+
+private:
+    const char* name_ {};
+    quint64 generation_ {}; // 0 unless a trace was active on entry
+    QString part_ {};
+    qint64 start_ns_ {};
+};
+
+YXLSX_END_NAMESPACE
+
+// YXLSX_TRACE_SCOPE(name, part) traces the enclosing scope; it expands to nothing without YXLSX_TRACE.
+#if defined(YXLSX_TRACE)
+#define YXLSX_TRACE_CONCAT_IMPL(a, b) a##b
+#define YXLSX_TRACE_CONCAT(a, b) YXLSX_TRACE_CONCAT_IMPL(a, b)
+#define YXLSX_TRACE_SCOPE(name, part) const yxlsx::TraceScope YXLSX_TRACE_CONCAT(trace_scope_, __LINE__)(name, part)
+#else
+#define YXLSX_TRACE_SCOPE(name, part)
+#endif
+
+#endif // YXLSX_TRACESCOPE_H
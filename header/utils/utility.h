@@ -25,6 +25,14 @@
 #ifndef YXLSX_UTILITY_H
 #define YXLSX_UTILITY_H
 
+#include <QtCore/qarraydata.h>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
 #include "namespace.h"
 
 YXLSX_BEGIN_NAMESPACE
@@ -38,9 +46,15 @@ struct CellAddress {
     bool IsBeforeOrEqual(const CellAddress& other) const { return row <= other.row && column <= other.column; }
 };
 
+// Result of one pass over a UTF-8 text node, see Utility::ScanText().
+struct TextScan {
+    bool needs_escape { false }; // contains <, >, &, \r or another control character
+    bool needs_space_preserve { false }; // leading or trailing whitespace, or two spaces in a row
+};
+
 class Utility {
 public:
-    static CellAddress ParseCoordinate(const QString& coordinate);
+    static CellAddress ParseCoordinate(QStringView coordinate);
     static QString ComposeCoordinate(int row, int column, bool row_abs = false, bool col_abs = false);
     static QStringList SplitPath(const QString& path);
     static QString GetRelFilePath(const QString& filePath);
@@ -48,11 +62,33 @@ public:
     static QString GenerateSheetName(const QStringList& sheet_names, const QString& name_proposal, int& last_sheet_index);
     static QString UnescapeSheetName(const QString& sheetName);
 
-    static bool IsSpacePreserveNeeded(const QString& string);
+    static bool IsSpacePreserveNeeded(QStringView string);
+    static bool IsSpacePreserveNeeded(QByteArrayView utf8);
+    static TextScan ScanText(QByteArrayView utf8);
+    static void AppendEscaped(QByteArray& xml, QByteArrayView utf8);
     static constexpr bool IsValidRowColumn(int row, int column) { return row >= 1 && row <= kMaxExcelRow && column >= 1 && column <= kMaxExcelColumn; }
 
+    // Heap bytes held by a container: its capacity plus the array header and the allocator's own.
+    static inline qint64 HeapSize(const QByteArray& bytes) { return bytes.capacity() > 0 ? kHeapBlockOverhead + bytes.capacity() + 1 : 0; }
+    static inline qint64 HeapSize(const QString& string) { return string.capacity() > 0 ? kHeapBlockOverhead + (string.capacity() + 1) * 2 : 0; }
+    template <typename T> static inline qint64 HeapSize(const QList<T>& list)
+    {
+        return list.capacity() > 0 ? kHeapBlockOverhead + list.capacity() * static_cast<qint64>(sizeof(T)) : 0;
+    }
+    // Hash tables keep about one byte of bucket offset beside each node.
+    template <typename K, typename V> static inline qint64 HeapSize(const QHash<K, V>& hash)
+    {
+        return hash.capacity() > 0 ? kHeapBlockOverhead + hash.capacity() * static_cast<qint64>(sizeof(K) + sizeof(V) + 1) : 0;
+    }
+    template <typename T> static inline qint64 HeapSize(const QSet<T>& set)
+    {
+        return set.capacity() > 0 ? kHeapBlockOverhead + set.capacity() * static_cast<qint64>(sizeof(T) + 1) : 0;
+    }
+
 private:
     static QString ComposeColumn(int column);
+
+    static constexpr qint64 kHeapBlockOverhead { static_cast<qint64>(sizeof(QArrayData)) + 16 }; // 16: malloc bookkeeping
 };
 
 YXLSX_END_NAMESPACE
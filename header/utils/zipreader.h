@@ -27,6 +27,7 @@
 
 #include <private/qzipreader_p.h>
 
+#include <QHash>
 #include <QScopedPointer>
 
 #include "namespace.h"
@@ -42,7 +43,8 @@ public:
     ~ZipReader() = default;
 
     inline const QStringList& GetFilePath() const { return file_path_; }
-    inline QByteArray GetFileData(const QString& file_path) const { return reader_->fileData(file_path); }
+    QByteArray GetFileData(const QString& file_path) const;
+    inline quint32 GetFileCrc(const QString& file_path) const { return file_crc_hash_.value(file_path); }
 
 private:
     void Init();
@@ -50,6 +52,7 @@ private:
 private:
     QScopedPointer<QZipReader> reader_ {};
     QStringList file_path_ {};
+    QHash<QString, quint32> file_crc_hash_ {}; // CRC-32 of each entry, from the central directory
 };
 
 YXLSX_END_NAMESPACE
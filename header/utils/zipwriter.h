@@ -42,8 +42,8 @@ public:
     explicit ZipWriter(QIODevice* device);
     ~ZipWriter() = default;
 
-    inline void AddFile(const QString& file_path, QIODevice* device) { writer_->addFile(file_path, device); }
-    inline void AddFile(const QString& file_path, const QByteArray& data) { writer_->addFile(file_path, data); }
+    void AddFile(const QString& file_path, QIODevice* device);
+    void AddFile(const QString& file_path, const QByteArray& data);
 
     inline bool IsError() const { return writer_->status() != QZipWriter::NoError; }
     inline void Close() { writer_->close(); }
@@ -27,6 +27,7 @@
 #include <QBuffer>
 
 #include "relationshipmgr.h"
+#include "tracescope.h"
 
 YXLSX_BEGIN_NAMESPACE
 
@@ -40,6 +41,8 @@ AbstractOOXmlFile::~AbstractOOXmlFile() { }
 
 QByteArray AbstractOOXmlFile::ComposeByteArray() const
 {
+    YXLSX_TRACE_SCOPE("ComposeByteArray", xml_path_);
+
     QByteArray data {};
     QBuffer buffer(&data);
     buffer.open(QIODevice::WriteOnly);
@@ -50,6 +53,8 @@ QByteArray AbstractOOXmlFile::ComposeByteArray() const
 
 bool AbstractOOXmlFile::ParseByteArray(const QByteArray& data)
 {
+    YXLSX_TRACE_SCOPE("ParseByteArray", xml_path_);
+
     QBuffer buffer {};
     buffer.setData(data);
     buffer.open(QIODevice::ReadOnly);
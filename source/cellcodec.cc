@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cellcodec.h"
+
+#include <QDateTime>
+#include <QDebug>
+
+#include "rowreader.h"
+#include "sharedstring.h"
+#include "utility.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+CellType CellCodec::DetermineCellType(const QVariant& value, StringType string_type)
+{
+    if (!value.isValid())
+        return CellType::kEmpty;
+
+    switch (value.typeId()) {
+    case QMetaType::Bool:
+        return CellType::kBoolean;
+
+    case QMetaType::Int:
+    case QMetaType::UInt:
+    case QMetaType::LongLong:
+    case QMetaType::ULongLong:
+    case QMetaType::Double:
+    case QMetaType::Float:
+        return CellType::kNumber;
+
+    case QMetaType::QDateTime:
+        return CellType::kDateTime;
+
+    case QMetaType::QString:
+        return string_type == StringType::kSharedString ? CellType::kSharedString : CellType::kInlineString;
+
+    default:
+        qWarning() << "Unsupported QVariant type:" << value.typeName();
+        return CellType::kSharedString; // Excel safest fallback
+    }
+}
+
+void CellCodec::ComposeCell(QXmlStreamWriter& writer, int row, int column, const Cell& cell, const SharedString* shared_string)
+{
+    // This is the innermost loop so efficiency is important.
+    const QString coord { Utility::ComposeCoordinate(row, column) };
+
+    writer.writeStartElement(QLatin1String("c"));
+    writer.writeAttribute(QLatin1String("r"), coord);
+
+    // -------------------
+    // Set style index to small font + shrinkToFit
+    // -------------------
+    writer.writeAttribute(QLatin1String("s"), QString::number(kDefaultStyleIndex)); // All cells use shrinkToFit style
+
+    // Empty cell must still be written
+    if (cell.type == CellType::kEmpty) {
+        writer.writeEndElement();
+        return;
+    }
+
+    switch (cell.type) {
+    case CellType::kSharedString: { // 's'
+        int shared_string_index { cell.value.toInt() };
+
+        if (shared_string_index < 0 || !shared_string || shared_string_index >= shared_string->Count()) {
+            qWarning() << "Missing shared string:" << shared_string_index;
+            shared_string_index = 0; // or fallback safe value
+        }
+
+        writer.writeAttribute(QLatin1String("t"), QLatin1String("s"));
+        writer.writeTextElement(QLatin1String("v"), QString::number(shared_string_index));
+        break;
+    }
+    case CellType::kNumber: { // 'n'
+        writer.writeAttribute(QLatin1String("t"), QLatin1String("n"));
+        writer.writeTextElement(QLatin1String("v"), QString::number(cell.value.toDouble(), 'g', 15));
+        break;
+    }
+    case CellType::kBoolean: { // 'b'
+        writer.writeAttribute(QLatin1String("t"), QLatin1String("b"));
+        writer.writeTextElement(QLatin1String("v"), cell.value.toBool() ? QLatin1String("1") : QLatin1String("0"));
+        break;
+    }
+    case CellType::kDateTime: {
+        writer.writeAttribute(QLatin1String("t"), QLatin1String("d"));
+        writer.writeTextElement(QLatin1String("v"), cell.value.toDateTime().toString(Qt::ISODateWithMs));
+        break;
+    }
+    case CellType::kInlineString: { // 'inlineStr'
+        writer.writeAttribute(QLatin1String("t"), QLatin1String("inlineStr"));
+
+        const QByteArray text { cell.value.toByteArray() }; // UTF-8
+
+        writer.writeStartElement(QLatin1String("is"));
+        writer.writeStartElement(QLatin1String("t"));
+
+        if (Utility::IsSpacePreserveNeeded(QByteArrayView(text))) {
+            writer.writeAttribute(QStringLiteral("http://www.w3.org/XML/1998/namespace"), QStringLiteral("space"), QStringLiteral("preserve"));
+        }
+
+        writer.writeCharacters(QUtf8StringView(text));
+
+        writer.writeEndElement(); // </t>
+        writer.writeEndElement(); // </is>
+
+        break;
+    }
+    default:
+        qWarning() << "Unsupported CellType";
+        break;
+    }
+
+    writer.writeEndElement();
+}
+
+QVariant CellCodec::ParseCellValue(const RawCell& cell, SharedString* shared_string)
+{
+    switch (cell.type) {
+    case CellType::kSharedString: {
+        const int index { cell.SharedStringIndex() };
+
+        if (!shared_string || index < 0 || index >= shared_string->Count()) {
+            return QVariant();
+        }
+
+        shared_string->IncrementReference(index);
+        return index;
+    }
+    case CellType::kInlineString:
+        return cell.utf8;
+    default:
+        return RowReader::ParseValue(cell.text, cell.type);
+    }
+}
+
+YXLSX_END_NAMESPACE
@@ -0,0 +1,60 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cellref.h"
+
+#include "sharedstring.h"
+#include "worksheet.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+/*!
+ * Returns the UTF-8 text of a shared or inline string cell, or an empty view for other cells.
+ */
+QUtf8StringView CellRef::Text() const
+{
+    const Cell& cell { entry_->cell };
+
+    if (cell.type == CellType::kSharedString && cell.value.isValid() && shared_string_) {
+        const QByteArrayView view { shared_string_->GetSharedStringView(cell.value.toInt()) };
+        return QUtf8StringView(view.data(), view.size());
+    }
+
+    if (cell.type == CellType::kInlineString) {
+        if (const QByteArray* text { get_if<QByteArray>(&cell.value) })
+            return QUtf8StringView(*text);
+    }
+
+    return {};
+}
+
+/*!
+ * Returns the value of the cell as Worksheet::Read() would.
+ */
+QVariant CellRef::Value() const
+{
+    return Worksheet::ReadCell(entry_->cell, shared_string_);
+}
+
+YXLSX_END_NAMESPACE
@@ -0,0 +1,206 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "cellstore.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "utility.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+namespace {
+
+// Dimensions are hints: some writers emit A1:XFD1048576 for any sheet.
+constexpr int kMaxRowReserve { 1 << 18 };
+constexpr int kMaxColumnReserve { 256 };
+
+}
+
+/*!
+ * Reserves room for \a row_count rows, each row reserves \a column_count cells when it is first written.
+ * Both are hints, no row is created.
+ */
+void CellStore::Reserve(int row_count, int column_count)
+{
+    if (row_count > 0)
+        row_list_.reserve(std::min(row_count, kMaxRowReserve));
+
+    column_reserve_ = std::clamp(column_count, 0, kMaxColumnReserve);
+}
+
+/*!
+ * Returns the stored \a row, inserting an empty one in order if it is new.
+ */
+QList<CellStore::RowEntry>::iterator CellStore::FindOrInsertRow(int row)
+{
+    // Fast path: rows usually arrive in order, and a row is usually written cell after cell.
+    if (row_list_.isEmpty() || row_list_.constLast().row < row) {
+        row_list_.append({ row, {} });
+        return std::prev(row_list_.end());
+    }
+
+    if (row_list_.constLast().row == row)
+        return std::prev(row_list_.end());
+
+    auto it { std::lower_bound(row_list_.begin(), row_list_.end(), row, [](const RowEntry& entry, int value) { return entry.row < value; }) };
+    if (it != row_list_.end() && it->row == row)
+        return it;
+
+    return row_list_.insert(it, { row, {} });
+}
+
+/*!
+ * Makes the rows \a row to \a row + \a row_count - 1 stored rows, in one pass over the row list,
+ * and returns the position of the first. Rows that are new are empty.
+ */
+qsizetype CellStore::InsertRows(int row, int row_count)
+{
+    // Fast path: the block starts after the last stored row.
+    if (row_list_.isEmpty() || row_list_.constLast().row < row) {
+        const qsizetype first { row_list_.size() };
+        for (int offset = 0; offset != row_count; ++offset)
+            row_list_.append({ row + offset, {} });
+
+        return first;
+    }
+
+    // A single row is usually the last one, written cell after cell.
+    if (row_count == 1 && row_list_.constLast().row == row)
+        return row_list_.size() - 1;
+
+    const qsizetype first { std::distance(row_list_.cbegin(), LowerBound(row)) };
+    const qsizetype end { std::distance(row_list_.cbegin(), LowerBound(row + row_count)) };
+
+    const qsizetype missing { row_count - (end - first) };
+    if (missing == 0)
+        return first;
+
+    // The tail moves once, then the stored rows of the block move to their places from the back.
+    row_list_.insert(end, missing, RowEntry {});
+
+    qsizetype source { end - 1 };
+    for (qsizetype target = first + row_count - 1; target >= first; --target) {
+        const int target_row { row + static_cast<int>(target - first) };
+
+        if (source >= first && row_list_.at(source).row == target_row) {
+            if (source != target)
+                row_list_[target] = std::move(row_list_[source]);
+
+            --source;
+        } else {
+            row_list_[target] = { target_row, {} };
+        }
+    }
+
+    return first;
+}
+
+/*!
+ * Drops the rows of the block of \a row_count rows at \a first that hold no cell.
+ */
+void CellStore::DropEmptyRows(qsizetype first, int row_count)
+{
+    const auto begin { row_list_.begin() + first };
+    const auto end { begin + row_count };
+
+    const auto it { std::remove_if(begin, end, [](const RowEntry& entry) { return entry.entry_list.isEmpty(); }) };
+    if (it != end)
+        row_list_.erase(it, end);
+}
+
+/*!
+ * Writes \a cell at (\a row, \a column). If a cell is overwritten and \a replaced is not null,
+ * the previous cell is moved into it.
+ */
+void CellStore::Write(int row, int column, Cell cell, Cell* replaced)
+{
+    Q_ASSERT(row >= 1 && column >= 1);
+
+    WriteEntry(FindOrInsertRow(row)->entry_list, column, std::move(cell), replaced);
+}
+
+/*!
+ * Writes \a cell at \a column of the stored row \a entry_list, see Write().
+ */
+void CellStore::WriteEntry(Row& entry_list, int column, Cell cell, Cell* replaced)
+{
+    Q_ASSERT(column >= 1);
+
+    if (entry_list.isEmpty() && column_reserve_ > 0)
+        entry_list.reserve(column_reserve_);
+
+    // Fast path: cells usually arrive in column order.
+    if (entry_list.isEmpty() || entry_list.constLast().column < column) {
+        entry_list.append({ column, std::move(cell) });
+        ++cell_count_;
+        return;
+    }
+
+    auto it { std::lower_bound(entry_list.begin(), entry_list.end(), column, [](const Entry& entry, int value) { return entry.column < value; }) };
+
+    if (it != entry_list.end() && it->column == column) {
+        if (replaced)
+            *replaced = std::move(it->cell);
+
+        it->cell = std::move(cell);
+        return;
+    }
+
+    entry_list.insert(it, { column, std::move(cell) });
+    ++cell_count_;
+}
+
+const Cell* CellStore::Read(int row, int column) const
+{
+    const auto row_it { LowerBound(row) };
+    if (row_it == row_list_.cend() || row_it->row != row)
+        return nullptr;
+
+    const Row& entry_list { row_it->entry_list };
+
+    auto it { std::lower_bound(entry_list.cbegin(), entry_list.cend(), column, [](const Entry& entry, int value) { return entry.column < value; }) };
+    if (it == entry_list.cend() || it->column != column)
+        return nullptr;
+
+    return &it->cell;
+}
+
+QList<CellStore::RowEntry>::const_iterator CellStore::LowerBound(int row) const
+{
+    return std::lower_bound(row_list_.cbegin(), row_list_.cend(), row, [](const RowEntry& entry, int value) { return entry.row < value; });
+}
+
+qint64 CellStore::MemoryUsage() const
+{
+    qint64 size { Utility::HeapSize(row_list_) };
+    for (const RowEntry& entry : row_list_)
+        size += Utility::HeapSize(entry.entry_list);
+
+    return size;
+}
+
+YXLSX_END_NAMESPACE
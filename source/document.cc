@@ -29,8 +29,11 @@
 
 #include "docpropsapp.h"
 #include "docpropscore.h"
+#include "phasetimer.h"
 #include "relationshipmgr.h"
+#include "rowindex.h"
 #include "sharedstring.h"
+#include "snapshot.h"
 #include "style.h"
 #include "utility.h"
 #include "zipreader.h"
@@ -64,18 +67,39 @@ bool Document::ParseXlsx(QIODevice* device)
     ZipReader zip_reader(device);
     const QStringList& file_paths { zip_reader.GetFilePath() };
 
+    DocumentStats* stats { Stats() };
+
+    // Inflates the part at path.
+    auto read = [&zip_reader, stats](const QString& path) {
+        PhaseTimer timer(stats, QStringLiteral("inflate"), path);
+        QByteArray data { zip_reader.GetFileData(path) };
+
+        timer.SetBytes(data.size());
+        if (stats)
+            stats->bytes_inflated += data.size();
+
+        return data;
+    };
+
+    // Parses data, the part at path, into file.
+    auto parse = [stats](AbstractOOXmlFile& file, const QString& path, const QByteArray& data) {
+        PhaseTimer timer(stats, QStringLiteral("parse"), path);
+        timer.SetBytes(data.size());
+        return file.ParseByteArray(data);
+    };
+
     // Load the Content_Types file
     if (!file_paths.contains(QStringLiteral("[Content_Types].xml")))
         return false;
 
     content_type_ = QSharedPointer<ContentType>::create(OperationMode::kLoadExisting);
-    content_type_->ParseByteArray(zip_reader.GetFileData(QStringLiteral("[Content_Types].xml")));
+    parse(*content_type_, QStringLiteral("[Content_Types].xml"), read(QStringLiteral("[Content_Types].xml")));
 
     // Load root rels file
     if (!file_paths.contains(QStringLiteral("_rels/.rels")))
         return false;
     RelationshipMgr root_rels {};
-    root_rels.ReadByteArray(zip_reader.GetFileData(QStringLiteral("_rels/.rels")));
+    root_rels.ReadByteArray(read(QStringLiteral("_rels/.rels")));
 
     // load core property
     QList<Relationship> core_rels { root_rels.GetPackageRelationship(QStringLiteral("/metadata/core-properties")) };
@@ -85,7 +109,7 @@ bool Document::ParseXlsx(QIODevice* device)
         const QString doc_props_core_name { core_rels[0].target };
 
         DocPropsCore props(OperationMode::kLoadExisting);
-        props.ParseByteArray(zip_reader.GetFileData(doc_props_core_name));
+        parse(props, doc_props_core_name, read(doc_props_core_name));
         const auto prop_names { props.GetProperty() };
         for (const QString& name : prop_names)
             SetProperty(name, props.GetProperty(name));
@@ -99,7 +123,7 @@ bool Document::ParseXlsx(QIODevice* device)
         const QString doc_props_app_Name { rels_app[0].target };
 
         DocPropsApp props(OperationMode::kLoadExisting);
-        props.ParseByteArray(zip_reader.GetFileData(doc_props_app_Name));
+        parse(props, doc_props_app_Name, read(doc_props_app_Name));
         const auto prop_names { props.GetProperty() };
         for (const QString& name : prop_names)
             SetProperty(name, props.GetProperty(name));
@@ -117,9 +141,9 @@ bool Document::ParseXlsx(QIODevice* device)
     const QString& workbook_dir { parts.first() };
     const QString rel_file_path { Utility::GetRelFilePath(workbook_path) };
 
-    workbook_->GetRelationship()->ReadByteArray(zip_reader.GetFileData(rel_file_path));
+    workbook_->GetRelationship()->ReadByteArray(read(rel_file_path));
     workbook_->SetXmlPath(workbook_path);
-    workbook_->ParseByteArray(zip_reader.GetFileData(workbook_path));
+    parse(*workbook_, workbook_path, read(workbook_path));
 
     // load styles
     QList<Relationship> rels_styles { workbook_->GetRelationship()->GetDocumentRelationship(QStringLiteral("/styles")) };
@@ -130,7 +154,7 @@ bool Document::ParseXlsx(QIODevice* device)
         // dev34
         const QString path { (workbook_dir == QStringLiteral(".")) ? name : workbook_dir + QStringLiteral("/") + name };
 
-        workbook_->GetStyle()->ParseByteArray(zip_reader.GetFileData(path));
+        parse(*workbook_->GetStyle(), path, read(path));
     }
 
     // load theme
@@ -140,7 +164,7 @@ bool Document::ParseXlsx(QIODevice* device)
         const QString name = rels_theme[0].target;
         const QString path = workbook_dir + QLatin1String("/") + name;
 
-        workbook_->GetTheme()->ParseByteArray(zip_reader.GetFileData(path));
+        parse(*workbook_->GetTheme(), path, read(path));
     }
 
     // load sharedStrings
@@ -149,9 +173,16 @@ bool Document::ParseXlsx(QIODevice* device)
         // In normal case this should be sharedStrings.xml which in xl
         const QString name { rels_sharedStrings[0].target };
         const QString path { (workbook_dir == QStringLiteral(".")) ? name : workbook_dir + QStringLiteral("/") + name };
-        workbook_->GetSharedString()->ParseByteArray(zip_reader.GetFileData(path));
+        workbook_->GetSharedString()->SetLazy(load_options_.lazy_shared_string);
+        parse(*workbook_->GetSharedString(), path, read(path));
     }
 
+    // load row index sidecar
+    const bool use_row_index { load_options_.row_index_stride > 0 && !xlsx_name_.isEmpty() };
+    const QString row_index_path { use_row_index ? RowIndex::SidecarPath(xlsx_name_) : QString() };
+    QHash<QString, RowIndex> row_index_hash { use_row_index ? RowIndex::Load(row_index_path) : QHash<QString, RowIndex> {} };
+    bool row_index_changed { false };
+
     // load sheets
     int sheet_count { workbook_->GetSheetCount() };
     for (int i = 0; i != sheet_count; ++i) {
@@ -160,22 +191,82 @@ bool Document::ParseXlsx(QIODevice* device)
         const QString rel_path = Utility::GetRelFilePath(xml_path);
         // If the .rel file exists, load it.
         if (zip_reader.GetFilePath().contains(rel_path))
-            sheet->GetRelationship()->ReadByteArray(zip_reader.GetFileData(rel_path));
-        sheet->ParseByteArray(zip_reader.GetFileData(sheet->GetXmlPath()));
+            sheet->GetRelationship()->ReadByteArray(read(rel_path));
+        if (auto worksheet { sheet.dynamicCast<Worksheet>() })
+            worksheet->SetLoadOptions(load_options_);
+
+        const QByteArray data { read(xml_path) };
+
+        if (use_row_index) {
+            const quint32 crc { zip_reader.GetFileCrc(xml_path) };
+            auto it { row_index_hash.constFind(xml_path) };
+
+            if (it != row_index_hash.constEnd() && it->Matches(crc, data.size(), load_options_.row_index_stride)) {
+                parse(*sheet, xml_path, it->Seek(data, load_options_.first_row));
+                continue;
+            }
+
+            RowIndex index {};
+            if (index.Build(data, crc, load_options_.row_index_stride)) {
+                row_index_hash.insert(xml_path, index);
+                row_index_changed = true;
+            }
+        }
+
+        parse(*sheet, xml_path, data);
     }
 
+    if (row_index_changed)
+        RowIndex::Save(row_index_path, row_index_hash);
+
     is_load_xlsx_ = true;
     return true;
 }
 
 bool Document::ComposeXlsx(QIODevice* device) const
 {
+    // Worksheets written in parallel may still be adding strings to their own tables.
+    if (workbook_->IsParallelWrite()) {
+        qWarning() << "Cannot save while parallel writing is enabled.";
+        return false;
+    }
+
     ZipWriter zip_writer(device);
     if (zip_writer.IsError())
         return false;
 
+    DocumentStats* stats { Stats() };
+    PhaseTimer save_timer(stats, QStringLiteral("save"));
+
+    // Serializes file, the part at path.
+    auto compose = [stats](const AbstractOOXmlFile& file, const QString& path) {
+        PhaseTimer timer(stats, QStringLiteral("compose"), path);
+        QByteArray data { file.ComposeByteArray() };
+        timer.SetBytes(data.size());
+        return data;
+    };
+
+    // Compresses data into the package as path.
+    auto add = [&zip_writer, stats](const QString& path, const QByteArray& data) {
+        PhaseTimer timer(stats, QStringLiteral("deflate"), path);
+        timer.SetBytes(data.size());
+        if (stats)
+            stats->bytes_deflated += data.size();
+
+        zip_writer.AddFile(path, data);
+    };
+
     content_type_->ClearOverride();
 
+    // Renumber shared strings first, the worksheets are written with the new indices.
+    {
+        PhaseTimer timer(stats, QStringLiteral("compact"));
+        workbook_->CompactSharedString();
+    }
+
+    if (stats)
+        stats->shared_string_written += workbook_->GetSharedString()->Count();
+
     DocPropsApp doc_props_app(OperationMode::kCreateNew);
     DocPropsCore doc_props_core(OperationMode::kCreateNew);
 
@@ -189,17 +280,18 @@ bool Document::ComposeXlsx(QIODevice* device) const
         content_type_->AddWorksheetName(QStringLiteral("sheet%1").arg(i + 1));
         doc_props_app.AddTitle(sheet->GetSheetName());
 
-        zip_writer.AddFile(QStringLiteral("xl/worksheets/sheet%1.xml").arg(i + 1), sheet->ComposeByteArray());
+        const QString sheet_path { QStringLiteral("xl/worksheets/sheet%1.xml").arg(i + 1) };
+        add(sheet_path, compose(*sheet, sheet_path));
 
         auto rel = sheet->GetRelationship();
         if (!rel->IsEmpty())
-            zip_writer.AddFile(QStringLiteral("xl/worksheets/_rels/sheet%1.xml.rels").arg(i + 1), rel->WriteByteArray());
+            add(QStringLiteral("xl/worksheets/_rels/sheet%1.xml.rels").arg(i + 1), rel->WriteByteArray());
     }
 
     // save workbook xml file
     content_type_->AddWorkbook();
-    zip_writer.AddFile(QStringLiteral("xl/workbook.xml"), workbook_->ComposeByteArray());
-    zip_writer.AddFile(QStringLiteral("xl/_rels/workbook.xml.rels"), workbook_->GetRelationship()->WriteByteArray());
+    add(QStringLiteral("xl/workbook.xml"), compose(*workbook_, QStringLiteral("xl/workbook.xml")));
+    add(QStringLiteral("xl/_rels/workbook.xml.rels"), workbook_->GetRelationship()->WriteByteArray());
 
     // save docProps app/core xml file
     const auto doc_prop_names = document_property_hash_.keys();
@@ -209,34 +301,38 @@ bool Document::ComposeXlsx(QIODevice* device) const
     }
     content_type_->AddDocPropApp();
     content_type_->AddDocPropCore();
-    zip_writer.AddFile(QStringLiteral("docProps/app.xml"), doc_props_app.ComposeByteArray());
-    zip_writer.AddFile(QStringLiteral("docProps/core.xml"), doc_props_core.ComposeByteArray());
+    add(QStringLiteral("docProps/app.xml"), compose(doc_props_app, QStringLiteral("docProps/app.xml")));
+    add(QStringLiteral("docProps/core.xml"), compose(doc_props_core, QStringLiteral("docProps/core.xml")));
 
     // save sharedStrings xml file
     if (!workbook_->GetSharedString()->IsEmpty()) {
         content_type_->AddSharedString();
-        zip_writer.AddFile(QStringLiteral("xl/sharedStrings.xml"), workbook_->GetSharedString()->ComposeByteArray());
+        add(QStringLiteral("xl/sharedStrings.xml"), compose(*workbook_->GetSharedString(), QStringLiteral("xl/sharedStrings.xml")));
     }
 
     // save styles xml file
     content_type_->AddStyles();
-    zip_writer.AddFile(QStringLiteral("xl/styles.xml"), workbook_->GetStyle()->ComposeByteArray());
+    add(QStringLiteral("xl/styles.xml"), compose(*workbook_->GetStyle(), QStringLiteral("xl/styles.xml")));
 
     // save theme xml file
     content_type_->AddTheme();
-    zip_writer.AddFile(QStringLiteral("xl/theme/theme1.xml"), workbook_->GetTheme()->ComposeByteArray());
+    add(QStringLiteral("xl/theme/theme1.xml"), compose(*workbook_->GetTheme(), QStringLiteral("xl/theme/theme1.xml")));
 
     // save root .rels xml file
     RelationshipMgr rootrels;
     rootrels.SetDocumentRelationship(QStringLiteral("/officeDocument"), QStringLiteral("xl/workbook.xml"));
     rootrels.SetPackageRelationship(QStringLiteral("/metadata/core-properties"), QStringLiteral("docProps/core.xml"));
     rootrels.SetDocumentRelationship(QStringLiteral("/extended-properties"), QStringLiteral("docProps/app.xml"));
-    zip_writer.AddFile(QStringLiteral("_rels/.rels"), rootrels.WriteByteArray());
+    add(QStringLiteral("_rels/.rels"), rootrels.WriteByteArray());
 
     // save content types xml file
-    zip_writer.AddFile(QStringLiteral("[Content_Types].xml"), content_type_->ComposeByteArray());
+    add(QStringLiteral("[Content_Types].xml"), compose(*content_type_, QStringLiteral("[Content_Types].xml")));
 
     zip_writer.Close();
+
+    if (stats && device->isOpen())
+        stats->bytes_written += device->size();
+
     return true;
 }
 
@@ -256,8 +352,20 @@ Document::Document(QObject* parent)
  * The \a parent argument is passed to QObject's constructor.
  */
 Document::Document(const QString& xlsx_name, QObject* parent)
+    : Document { xlsx_name, LoadOptions {}, parent }
+{
+}
+
+/*!
+ * \overload
+ * Try to open an existing xlsx document named \a xlsx_name, keeping only the rows and
+ * columns selected by \a options in every worksheet.
+ * The \a parent argument is passed to QObject's constructor.
+ */
+Document::Document(const QString& xlsx_name, const LoadOptions& options, QObject* parent)
     : QObject { parent }
     , xlsx_name_ { xlsx_name }
+    , load_options_ { options }
 {
     if (xlsx_name.isEmpty()) {
         qWarning() << "Empty file name provided for the document.";
@@ -266,15 +374,39 @@ Document::Document(const QString& xlsx_name, QObject* parent)
 
     QFileInfo file_info(xlsx_name);
     if (file_info.exists() && file_info.isFile()) {
-        QFile xlsx(xlsx_name);
-        if (!xlsx.open(QFile::ReadOnly)) {
-            qWarning() << "Failed to open the file:" << xlsx_name;
-            return;
+        DocumentStats* stats { Stats() };
+        PhaseTimer load_timer(stats, QStringLiteral("load"));
+
+        // A snapshot holds the whole workbook, so it cannot serve a filtered load.
+        const bool use_snapshot { load_options_.use_snapshot && !load_options_.HasFilter() };
+
+        bool from_snapshot { false };
+        if (use_snapshot) {
+            PhaseTimer timer(stats, QStringLiteral("snapshot"), xlsx_name);
+            from_snapshot = Snapshot::Load(xlsx_name, *this);
         }
 
-        if (!ParseXlsx(&xlsx)) {
-            qWarning() << "Failed to load the package for document:" << xlsx_name;
-            return;
+        if (!from_snapshot) {
+            QFile xlsx(xlsx_name);
+            if (!xlsx.open(QFile::ReadOnly)) {
+                qWarning() << "Failed to open the file:" << xlsx_name;
+                return;
+            }
+
+            if (!ParseXlsx(&xlsx)) {
+                qWarning() << "Failed to load the package for document:" << xlsx_name;
+                return;
+            }
+
+            if (use_snapshot)
+                Snapshot::Save(xlsx_name, *this);
+        }
+
+        // Counted from the loaded workbook, so both paths report the same.
+        if (stats) {
+            stats->shared_string_read += workbook_->GetSharedString()->Count();
+            for (const auto& sheet : workbook_->GetSheetByType(SheetType::kWorkSheet))
+                sheet.staticCast<Worksheet>()->CountCellType(stats->cell_count_hash);
         }
     } else {
         qWarning() << "File does not exist, initializing a new document:" << xlsx_name;
@@ -330,6 +462,12 @@ bool Document::Save() const { return Save(xlsx_name_.isEmpty() ? kDefaultXlsxNam
  */
 bool Document::Save(const QString& xlsx_name) const
 {
+    // Checked before the file is opened, so a refused save leaves it untouched.
+    if (workbook_->IsParallelWrite()) {
+        qWarning() << "Cannot save while parallel writing is enabled:" << xlsx_name;
+        return false;
+    }
+
     QFile file(xlsx_name);
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "Failed to open file for writing:" << xlsx_name;
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "loadoptions.h"
+
+#include <QSharedPointer>
+#include <algorithm>
+
+#include "sharedstring.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+const RawCell* RawRow::Find(int column) const
+{
+    // Rows are short, a linear scan also copes with cells written out of order.
+    auto it { std::find_if(cells.cbegin(), cells.cend(), [column](const RawCell& cell) { return cell.column == column; }) };
+    return it == cells.cend() ? nullptr : &*it;
+}
+
+RowPredicate LoadOptions::ColumnEquals(int column, const QString& text)
+{
+    // The index is resolved once per table generation and size and cached, so each row costs an
+    // integer comparison instead of a string comparison. A later load or a renumbered table has
+    // another generation, a table that grew may hold the text now; both resolve the index again.
+    struct Lookup {
+        quint64 generation {};
+        qsizetype count { -1 };
+        int index { -1 };
+    };
+
+    auto lookup { QSharedPointer<Lookup>::create() };
+    const QByteArray utf8 { text.toUtf8() };
+
+    return [column, text, utf8, lookup](const RawRow& row) {
+        const RawCell* cell { row.Find(column) };
+        if (!cell)
+            return false;
+
+        switch (cell->type) {
+        case CellType::kSharedString:
+            if (!row.shared_string)
+                return false;
+
+            if (lookup->generation != row.shared_string->Generation() || lookup->count != row.shared_string->Count()) {
+                lookup->generation = row.shared_string->Generation();
+                lookup->count = row.shared_string->Count();
+                lookup->index = row.shared_string->GetSharedStringIndex(text);
+            }
+
+            return lookup->index >= 0 && cell->SharedStringIndex() == lookup->index;
+        case CellType::kInlineString:
+            return cell->utf8 == utf8;
+        default:
+            return false;
+        }
+    };
+}
+
+YXLSX_END_NAMESPACE
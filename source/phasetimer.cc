@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "phasetimer.h"
+
+#if defined(Q_OS_UNIX)
+#include <time.h>
+#endif
+
+YXLSX_BEGIN_NAMESPACE
+
+PhaseTimer::PhaseTimer(DocumentStats* stats, QString phase, QString part)
+    : stats_ { stats }
+    , phase_ { std::move(phase) }
+    , part_ { std::move(part) }
+{
+    if (!stats_)
+        return;
+
+    cpu_start_ns_ = ThreadCpuNs();
+    timer_.start();
+}
+
+PhaseTimer::~PhaseTimer()
+{
+    if (!stats_)
+        return;
+
+    const qint64 wall_ns { timer_.nsecsElapsed() };
+    const qint64 cpu_ns { cpu_start_ns_ < 0 ? -1 : ThreadCpuNs() - cpu_start_ns_ };
+
+    stats_->phase_list.emplaceBack(PhaseStats { std::move(phase_), std::move(part_), wall_ns, cpu_ns, bytes_ });
+}
+
+/*!
+ * \internal
+ * Returns the CPU time consumed by the calling thread, or -1 if the platform does not provide it.
+ */
+qint64 PhaseTimer::ThreadCpuNs()
+{
+#if defined(Q_OS_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec time {};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+        return -1;
+
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#else
+    return -1;
+#endif
+}
+
+YXLSX_END_NAMESPACE
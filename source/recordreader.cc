@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "recordreader.h"
+
+#include <cmath>
+
+#include "sharedstring.h"
+#include "streamrows.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+namespace {
+
+// Excel serial dates count days from 1899-12-30, the fraction is the time of day.
+constexpr qint64 kMsecPerDay { 86400000 };
+
+// Excel treats 1900 as a leap year: serial 60 is the fictitious 1900-02-29, and serials
+// before it are one day off when counted from 1899-12-30.
+constexpr qint64 kLeapBugSerial { 60 };
+
+// Text of a string cell, resolving a shared string index against the row's table.
+bool ReadText(const RawRow& row, const RawCell& cell, QString& text)
+{
+    if (cell.type != CellType::kSharedString) {
+        text = cell.Text();
+        return true;
+    }
+
+    const int index { cell.SharedStringIndex() };
+    if (!row.shared_string || index < 0 || index >= row.shared_string->Count())
+        return false;
+
+    text = row.shared_string->GetSharedString(index);
+    return true;
+}
+
+bool ReadNumber(const RawRow& row, const RawCell& cell, double& value)
+{
+    switch (cell.type) {
+    case CellType::kNumber:
+        break;
+    case CellType::kBoolean:
+        value = cell.text == QLatin1String("1") || cell.text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0 ? 1.0 : 0.0;
+        return true;
+    case CellType::kSharedString:
+    case CellType::kInlineString: {
+        QString text {};
+        if (!ReadText(row, cell, text))
+            return false;
+
+        bool ok { false };
+        value = QStringView(text).trimmed().toDouble(&ok);
+        return ok;
+    }
+    default:
+        return false;
+    }
+
+    bool ok { false };
+    value = cell.text.toDouble(&ok);
+    return ok;
+}
+
+} // namespace
+
+RecordReaderBase::RecordReaderBase(QString xlsx_name, QString sheet_name, LoadOptions options)
+    : row_generator_ { StreamRawRows(std::move(xlsx_name), std::move(sheet_name), std::move(options)) }
+{
+}
+
+/*!
+ * Advances to the next accepted row, the row is valid until the next call.
+ * Returns nullptr after the last row.
+ */
+const RawRow* RecordReaderBase::NextRow()
+{
+    if (started_) {
+        ++row_iterator_;
+    } else {
+        row_iterator_ = row_generator_.begin();
+        started_ = true;
+    }
+
+    if (row_iterator_ == std::default_sentinel)
+        return nullptr;
+
+    return &*row_iterator_;
+}
+
+void RecordReaderBase::AddError(const RawRow& row, const RawCell& cell) { error_list_.emplaceBack(RecordError { row.row, cell.column, cell.type, cell.Text() }); }
+
+bool RecordReaderBase::Decode(const RawRow& /*row*/, const RawCell& cell, bool& value)
+{
+    if (cell.type != CellType::kBoolean)
+        return false;
+
+    value = cell.text == QLatin1String("1") || cell.text.compare(QLatin1String("true"), Qt::CaseInsensitive) == 0;
+    return true;
+}
+
+/*!
+ * Reads an integer, a number cell holding a whole double such as "1E3" is accepted too.
+ */
+bool RecordReaderBase::Decode(const RawRow& row, const RawCell& cell, qint64& value)
+{
+    if (cell.type == CellType::kNumber) {
+        bool ok { false };
+        value = cell.text.toLongLong(&ok);
+        if (ok)
+            return true;
+    }
+
+    double number {};
+    if (!ReadNumber(row, cell, number) || std::trunc(number) != number || !(std::fabs(number) < 0x1p63))
+        return false;
+
+    value = static_cast<qint64>(number);
+    return true;
+}
+
+bool RecordReaderBase::Decode(const RawRow& row, const RawCell& cell, double& value) { return ReadNumber(row, cell, value); }
+
+bool RecordReaderBase::Decode(const RawRow& row, const RawCell& cell, QString& value) { return ReadText(row, cell, value); }
+
+bool RecordReaderBase::Decode(const RawRow& row, const RawCell& cell, QByteArray& value)
+{
+    if (cell.type == CellType::kInlineString) {
+        value = cell.utf8;
+        return true;
+    }
+
+    if (cell.type != CellType::kSharedString) {
+        value = cell.text.toUtf8();
+        return true;
+    }
+
+    const int index { cell.SharedStringIndex() };
+    if (!row.shared_string || index < 0 || index >= row.shared_string->Count())
+        return false;
+
+    value = row.shared_string->GetSharedStringUtf8(index);
+    return true;
+}
+
+/*!
+ * Reads an ISO 8601 date cell or string, or an Excel serial date number in the 1900 date system.
+ * Serial 60, the 1900-02-29 Excel counts but the calendar does not have, does not convert.
+ */
+bool RecordReaderBase::Decode(const RawRow& row, const RawCell& cell, QDateTime& value)
+{
+    if (cell.type == CellType::kNumber) {
+        bool ok { false };
+        const double serial { cell.text.toDouble(&ok) };
+        if (!ok || !(serial >= 0.0 && serial < 2958466.0)) // 9999-12-31 is the last Excel date
+            return false;
+
+        // Days and time of day are applied separately, so no DST shift is added to the time.
+        qint64 days { static_cast<qint64>(serial) };
+        qint64 msecs { std::llround((serial - static_cast<double>(days)) * static_cast<double>(kMsecPerDay)) };
+        if (msecs == kMsecPerDay) {
+            ++days;
+            msecs = 0;
+        }
+
+        if (days == kLeapBugSerial)
+            return false;
+
+        if (days < kLeapBugSerial)
+            ++days;
+
+        value = QDateTime(QDate(1899, 12, 30).addDays(days), QTime::fromMSecsSinceStartOfDay(static_cast<int>(msecs)));
+        return true;
+    }
+
+    if (cell.type != CellType::kDateTime && cell.type != CellType::kSharedString && cell.type != CellType::kInlineString)
+        return false;
+
+    QString text {};
+    if (!ReadText(row, cell, text))
+        return false;
+
+    value = QDateTime::fromString(text.trimmed(), Qt::ISODate);
+    return value.isValid();
+}
+
+YXLSX_END_NAMESPACE
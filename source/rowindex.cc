@@ -0,0 +1,229 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rowindex.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+
+YXLSX_BEGIN_NAMESPACE
+
+namespace {
+
+constexpr quint32 kRowIndexMagic { 0x59585249 }; // "YXRI"
+constexpr quint16 kRowIndexVersion { 1 };
+
+}
+
+/*!
+ * Scans \a xml for <row> start tags and records every \a stride th of them.
+ * Returns false if the xml has no <sheetData> or no rows.
+ */
+bool RowIndex::Build(const QByteArray& xml, quint32 crc, int stride)
+{
+    entry_list_.clear();
+
+    if (stride <= 0)
+        return false;
+
+    const qsizetype sheet_data { xml.indexOf("<sheetData") };
+    if (sheet_data < 0)
+        return false;
+
+    const qsizetype start_tag_end { xml.indexOf('>', sheet_data) };
+    if (start_tag_end < 0 || xml.at(start_tag_end - 1) == '/') // <sheetData/>
+        return false;
+
+    const qsizetype sheet_data_end { xml.indexOf("</sheetData>", start_tag_end) };
+    const qsizetype end { sheet_data_end < 0 ? xml.size() : sheet_data_end };
+
+    // Text content cannot contain a raw '<', so every "<row" is a tag.
+    // The row number is read from every tag, rows without "r" follow the previous one.
+    int current_row { 0 };
+    int row_count { 0 };
+    qsizetype pos { start_tag_end + 1 };
+
+    while ((pos = xml.indexOf("<row", pos)) >= 0 && pos < end) {
+        const char next { pos + 4 < xml.size() ? xml.at(pos + 4) : '\0' };
+        if (next != ' ' && next != '>' && next != '/' && next != '\t' && next != '\r' && next != '\n') {
+            pos += 4;
+            continue;
+        }
+
+        const qsizetype tag_end { xml.indexOf('>', pos) };
+        if (tag_end < 0)
+            break;
+
+        const int row { ParseRowNumber(xml, pos + 4, tag_end) };
+        current_row = row > 0 ? row : current_row + 1;
+
+        if (row_count++ % stride == 0)
+            entry_list_.append({ current_row, pos });
+
+        pos = tag_end + 1;
+    }
+
+    if (entry_list_.isEmpty())
+        return false;
+
+    crc_ = crc;
+    size_ = xml.size();
+    sheet_data_offset_ = start_tag_end + 1;
+    stride_ = stride;
+    return true;
+}
+
+/*!
+ * Returns the value of the r attribute within the tag bytes [\a begin, \a end), or 0.
+ */
+int RowIndex::ParseRowNumber(const QByteArray& xml, qsizetype begin, qsizetype end)
+{
+    for (qsizetype i = begin; i + 3 < end; ++i) {
+        const char ch { xml.at(i) };
+        if ((ch != ' ' && ch != '\t' && ch != '\r' && ch != '\n') || xml.at(i + 1) != 'r' || xml.at(i + 2) != '=')
+            continue;
+
+        const char quote { xml.at(i + 3) };
+        if (quote != '"' && quote != '\'')
+            continue;
+
+        int row { 0 };
+        for (qsizetype j = i + 4; j < end && xml.at(j) >= '0' && xml.at(j) <= '9'; ++j)
+            row = row * 10 + (xml.at(j) - '0');
+
+        return row <= kMaxExcelRow ? row : 0;
+    }
+
+    return 0;
+}
+
+/*!
+ * Returns \a xml with the rows before the nearest indexed row at or above \a row removed.
+ * The part up to <sheetData> is kept, so the result is still a complete worksheet.
+ */
+QByteArray RowIndex::Seek(const QByteArray& xml, int row) const
+{
+    if (xml.size() != size_ || entry_list_.isEmpty())
+        return xml;
+
+    // First entry past the target, the one before it is where parsing starts.
+    auto it { std::upper_bound(entry_list_.cbegin(), entry_list_.cend(), row, [](int value, const Entry& entry) { return value < entry.row; }) };
+    if (it == entry_list_.cbegin())
+        return xml;
+
+    const qsizetype offset { std::prev(it)->offset };
+    if (offset <= sheet_data_offset_ || offset >= xml.size())
+        return xml;
+
+    QByteArray spliced {};
+    spliced.reserve(sheet_data_offset_ + xml.size() - offset);
+    spliced.append(xml.constData(), sheet_data_offset_);
+    spliced.append(xml.constData() + offset, xml.size() - offset);
+    return spliced;
+}
+
+QHash<QString, RowIndex> RowIndex::Load(const QString& sidecar_path)
+{
+    QHash<QString, RowIndex> index_hash {};
+
+    QFile file(sidecar_path);
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return index_hash;
+
+    QDataStream stream(&file);
+    quint32 magic {};
+    quint16 version {};
+    stream >> magic >> version;
+
+    if (magic != kRowIndexMagic || version != kRowIndexVersion) {
+        qWarning() << "Ignoring row index with unknown format:" << sidecar_path;
+        return index_hash;
+    }
+
+    qint32 sheet_count {};
+    stream >> sheet_count;
+
+    for (qint32 i = 0; i < sheet_count && stream.status() == QDataStream::Ok; ++i) {
+        QString xml_path {};
+        RowIndex index {};
+        qint64 size {};
+        qint64 sheet_data_offset {};
+        qint32 entry_count {};
+
+        stream >> xml_path >> index.crc_ >> size >> sheet_data_offset >> index.stride_ >> entry_count;
+        index.size_ = size;
+        index.sheet_data_offset_ = sheet_data_offset;
+
+        if (entry_count < 0 || entry_count > kMaxExcelRow) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            break;
+        }
+
+        index.entry_list_.reserve(entry_count);
+        for (qint32 j = 0; j < entry_count && stream.status() == QDataStream::Ok; ++j) {
+            qint32 row {};
+            qint64 offset {};
+            stream >> row >> offset;
+            index.entry_list_.append({ row, offset });
+        }
+
+        index_hash.insert(xml_path, index);
+    }
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring truncated row index:" << sidecar_path;
+        index_hash.clear();
+    }
+
+    return index_hash;
+}
+
+bool RowIndex::Save(const QString& sidecar_path, const QHash<QString, RowIndex>& index_hash)
+{
+    QSaveFile file(sidecar_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open row index for writing:" << sidecar_path;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << kRowIndexMagic << kRowIndexVersion << qint32(index_hash.size());
+
+    for (auto it = index_hash.cbegin(); it != index_hash.cend(); ++it) {
+        const RowIndex& index { it.value() };
+
+        stream << it.key() << index.crc_ << qint64(index.size_) << qint64(index.sheet_data_offset_) << qint32(index.stride_)
+               << qint32(index.entry_list_.size());
+
+        for (const auto& entry : index.entry_list_)
+            stream << qint32(entry.row) << qint64(entry.offset);
+    }
+
+    return file.commit();
+}
+
+YXLSX_END_NAMESPACE
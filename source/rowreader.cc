@@ -0,0 +1,282 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rowreader.h"
+
+#include <QDateTime>
+#include <QDebug>
+
+#include "coordinate.h"
+#include "utility.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+RowReader::RowReader(QIODevice* device, const LoadOptions& options, const SharedString* shared_string)
+    : reader_ { device }
+    , options_ { options }
+    , shared_string_ { shared_string }
+{
+}
+
+/*!
+ * Reads up to <sheetData>, keeping the <dimension> found on the way.
+ * Returns false if the part has no <sheetData>.
+ */
+bool RowReader::ReadHeader()
+{
+    while (!reader_.atEnd() && !reader_.hasError()) {
+        if (!reader_.readNextStartElement())
+            continue;
+
+        const QStringView name { reader_.name() };
+
+        if (name == QStringLiteral("dimension")) {
+            dimension_ = Dimension(reader_.attributes().value(QLatin1String("ref")).toString());
+            reader_.skipCurrentElement();
+        } else if (name == QStringLiteral("sheetData")) {
+            return true;
+        }
+    }
+
+    done_ = true;
+    return false;
+}
+
+/*!
+ * Tokenizes the next accepted row into \a row.
+ * Returns false after the last row of <sheetData>, or once a row lies beyond LoadOptions::last_row:
+ * rows are stored in ascending order so nothing after it can be accepted.
+ */
+bool RowReader::ReadRow(RawRow& row)
+{
+    while (!done_ && reader_.readNextStartElement()) {
+        if (reader_.name() != QStringLiteral("row")) {
+            reader_.skipCurrentElement();
+            continue;
+        }
+
+        switch (ParseRow(row)) {
+        case RowResult::kAccepted:
+            return true;
+        case RowResult::kSkipped:
+            continue;
+        case RowResult::kPastEnd:
+            done_ = true;
+            return false;
+        }
+    }
+
+    if (reader_.hasError()) {
+        qWarning() << "ParseSheet error:" << reader_.errorString();
+    }
+
+    done_ = true;
+    return false;
+}
+
+RowReader::RowResult RowReader::ParseRow(RawRow& row)
+{
+    Q_ASSERT(reader_.name() == QStringLiteral("row"));
+
+    if (options_.HasFilter()) {
+        // "r" is optional, rows without it are filtered per cell instead.
+        bool ok { false };
+        const int row_number { reader_.attributes().value(QLatin1String("r")).toInt(&ok) };
+
+        if (ok && row_number > options_.last_row)
+            return RowResult::kPastEnd;
+
+        if (ok && !options_.AcceptRow(row_number)) {
+            reader_.skipCurrentElement();
+            return RowResult::kSkipped;
+        }
+    }
+
+    row.cells.clear();
+
+    while (reader_.readNextStartElement()) {
+        if (reader_.name() == QStringLiteral("c")) {
+            ProcessCell(row);
+        } else {
+            reader_.skipCurrentElement();
+        }
+    }
+
+    if (row.cells.isEmpty())
+        return RowResult::kSkipped;
+
+    // The predicate sees the tokenized row, rejected rows are never decoded.
+    row.shared_string = shared_string_;
+    if (options_.row_predicate && !options_.row_predicate(row))
+        return RowResult::kSkipped;
+
+    return RowResult::kAccepted;
+}
+
+void RowReader::ProcessCell(RawRow& row)
+{
+    Q_ASSERT(reader_.name() == QStringLiteral("c"));
+
+    // Read cell attributes
+    QXmlStreamAttributes attributes { reader_.attributes() };
+
+    const auto address { Utility::ParseCoordinate(attributes.value(QLatin1String("r"))) };
+
+    if (!address.IsValid()) {
+        qWarning() << "Invalid cell reference:" << attributes.value(QLatin1String("r")) << "at line" << reader_.lineNumber() << "column"
+                   << reader_.columnNumber();
+        reader_.skipCurrentElement();
+        return;
+    }
+
+    const Coordinate coord { address.row, address.column };
+
+    // Projected out cells are skipped before their value is decoded.
+    if (options_.HasFilter() && (!options_.AcceptRow(coord.Row()) || !options_.AcceptColumn(coord.Column()))) {
+        reader_.skipCurrentElement();
+        return;
+    }
+
+    // Determine cell type
+    RawCell raw_cell { coord.Column(), CellType::kNumber, {} }; // default type is Number
+
+    if (attributes.hasAttribute(QLatin1String("t"))) {
+        const QStringView type { attributes.value(QLatin1String("t")) };
+
+        if (type == QLatin1String("s"))
+            raw_cell.type = CellType::kSharedString;
+        else if (type == QLatin1String("inlineStr"))
+            raw_cell.type = CellType::kInlineString;
+        else if (type == QLatin1String("str"))
+            raw_cell.type = CellType::kInlineString; // Formula string result, treated as plain string.
+        else if (type == QLatin1String("b"))
+            raw_cell.type = CellType::kBoolean;
+        else if (type == QLatin1String("d"))
+            raw_cell.type = CellType::kDateTime;
+        else if (type == QLatin1String("e"))
+            raw_cell.type = CellType::kError;
+        else if (type == QLatin1String("n"))
+            raw_cell.type = CellType::kNumber;
+        // otherwise keep default Number
+    }
+
+    // Parse sub-elements of the cell, the value stays undecoded until the row is accepted.
+    // Inline strings are kept in UTF-8, the way the cell stores them.
+    const bool is_inline { raw_cell.type == CellType::kInlineString };
+
+    while (reader_.readNextStartElement()) {
+        if (reader_.name() == QStringLiteral("v")) {
+            if (is_inline)
+                raw_cell.utf8 = ReadElementUtf8();
+            else
+                raw_cell.text = reader_.readElementText();
+        } else if (reader_.name() == QStringLiteral("is")) {
+            // inline string structure
+            while (reader_.readNextStartElement()) {
+                if (reader_.name() == QStringLiteral("t")) {
+                    raw_cell.utf8 = ReadElementUtf8();
+                } else {
+                    reader_.skipCurrentElement();
+                }
+            }
+
+        } else {
+            // Skip unknown sub-elements
+            reader_.skipCurrentElement();
+        }
+    }
+
+    if (reader_.hasError()) {
+        qWarning() << "XML Parsing Error in <c> at"
+                   << "row:" << coord.Row() << "col:" << coord.Column() << reader_.errorString();
+    }
+
+    // All cells of a <row> share its row number.
+    row.row = coord.Row();
+    row.cells.emplaceBack(std::move(raw_cell));
+}
+
+/*!
+ * \internal
+ * Reads the text of the current element like readElementText(), but converts each text token
+ * straight to UTF-8 instead of building a QString first. The result is never null.
+ */
+QByteArray RowReader::ReadElementUtf8()
+{
+    QByteArray text { "" };
+
+    while (!reader_.atEnd()) {
+        switch (reader_.readNext()) {
+        case QXmlStreamReader::Characters:
+        case QXmlStreamReader::EntityReference:
+            if (text.isEmpty())
+                text = reader_.text().toUtf8();
+            else
+                text.append(reader_.text().toUtf8());
+            break;
+        case QXmlStreamReader::StartElement:
+            reader_.skipCurrentElement();
+            break;
+        case QXmlStreamReader::EndElement:
+            return text;
+        default:
+            break;
+        }
+    }
+
+    return text;
+}
+
+/*!
+ * Decodes \a text of a boolean, date or number cell. Other types are returned as text.
+ */
+QVariant RowReader::ParseValue(const QString& text, CellType type)
+{
+    switch (type) {
+    case CellType::kBoolean: {
+        const QString lower = text.toLower();
+        return QVariant(lower == QLatin1String("true") || lower == QLatin1String("1"));
+    }
+    case CellType::kDateTime: {
+        QDateTime dt = QDateTime::fromString(text, Qt::ISODate);
+        if (!dt.isValid()) {
+            qWarning() << "Invalid date value.";
+        }
+        return QVariant::fromValue(dt);
+    }
+    case CellType::kNumber: {
+        bool ok = false;
+        double d = text.toDouble(&ok);
+        if (!ok) {
+            qWarning() << "Invalid numeric value.";
+        }
+        return QVariant(d);
+    }
+    default:
+        qWarning() << "Unsupported cell type, returning raw value.";
+        return text;
+    }
+}
+
+YXLSX_END_NAMESPACE
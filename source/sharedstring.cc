@@ -25,94 +25,494 @@
 #include "sharedstring.h"
 
 #include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <utility>
 
+#include "tracescope.h"
 #include "utility.h"
 
 YXLSX_BEGIN_NAMESPACE
 
+namespace {
+
+constexpr qsizetype kMinSlotCount { 16 };
+
+// ComposeXml() hands the part to the device in chunks of about this size.
+constexpr qsizetype kFlushSize { 1 << 16 };
+
+// Generations are drawn from one counter, so no two tables ever share one.
+quint64 NextGeneration()
+{
+    static std::atomic<quint64> counter {};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+// Returns true if the part is UTF-8 and its root element is an unprefixed <sst>, after the prolog.
+bool HasPlainRoot(QByteArrayView data)
+{
+    if (data.startsWith("\xEF\xBB\xBF"))
+        data = data.sliced(3);
+
+    while (true) {
+        data = data.trimmed();
+
+        // The declaration may name another encoding, only UTF-8 is read as bytes.
+        if (data.startsWith("<?xml ")) {
+            const qsizetype end { data.indexOf("?>") };
+            const QByteArrayView declaration { data.first(std::max<qsizetype>(end, 0)) };
+            const qsizetype encoding { declaration.indexOf("encoding=") };
+
+            if (encoding >= 0) {
+                const QByteArrayView name { declaration.sliced(encoding + 9).trimmed() };
+                if (name.size() < 6 || name.sliced(1, 5).compare("UTF-8", Qt::CaseInsensitive) != 0)
+                    return false;
+            }
+        }
+
+        QByteArrayView close {};
+        if (data.startsWith("<?"))
+            close = "?>";
+        else if (data.startsWith("<!--"))
+            close = "-->";
+        else
+            break;
+
+        const qsizetype end { data.indexOf(close) };
+        if (end < 0)
+            return false;
+
+        data = data.sliced(end + close.size());
+    }
+
+    if (!data.startsWith("<sst") || data.size() < 5)
+        return false;
+
+    const char next { data.at(4) };
+    return next == '>' || next == ' ' || next == '\t' || next == '\r' || next == '\n';
+}
+
+}
+
 SharedString::SharedString(OperationMode mode)
     : AbstractOOXmlFile { mode }
+    , generation_ { NextGeneration() }
+{
+}
+
+SharedString::SharedString(const SharedString& other)
+    : AbstractOOXmlFile { other }
+    , arena_ { other.arena_ }
+    , span_list_ { other.span_list_ }
+    , lazy_ { other.lazy_ }
+    , lazy_source_ { other.lazy_source_ }
+    , lazy_offset_list_ { other.lazy_offset_list_ }
+    , slot_list_ { other.slot_list_ }
+    , slot_used_ { other.slot_used_ }
+    , reference_list_ { other.reference_list_ }
+    , base_ { other.base_ }
+    , base_count_ { other.base_count_ }
+    , generation_ { NextGeneration() }
+{
+}
+
+SharedString& SharedString::operator=(const SharedString& other)
+{
+    if (this == &other)
+        return *this;
+
+    AbstractOOXmlFile::operator=(other);
+    arena_ = other.arena_;
+    span_list_ = other.span_list_;
+    lazy_ = other.lazy_;
+    lazy_source_ = other.lazy_source_;
+    lazy_offset_list_ = other.lazy_offset_list_;
+    slot_list_ = other.slot_list_;
+    slot_used_ = other.slot_used_;
+    reference_list_ = other.reference_list_;
+    base_ = other.base_;
+    base_count_ = other.base_count_;
+    generation_ = NextGeneration();
+
+    return *this;
+}
+
+SharedString::SharedString(const QSharedPointer<SharedString>& base)
+    : SharedString { OperationMode::kCreateNew }
+{
+    Q_ASSERT(base && !base->base_);
+
+    // Decoded up front, so the overlays of several threads only read base.
+    base->Materialize();
+    base_ = base;
+    base_count_ = static_cast<int>(base->Count());
+}
+
+/*!
+ * Adds a reference to \a string, inserting it into the table if it is new.
+ * Returns the index of the string.
+ */
+int SharedString::SetSharedString(QStringView string)
+{
+    const int index { Intern(string.toUtf8()) };
+
+    if (index >= base_count_)
+        ++reference_list_[index - base_count_];
+
+    return index;
+}
+
+/*!
+ * Returns the index of the UTF-8 \a string, inserting it if it is new. The string is hashed once.
+ */
+int SharedString::Intern(QByteArrayView string)
 {
+    Materialize();
+
+    const size_t hash { qHash(string) };
+
+    if (base_ && !base_->slot_list_.isEmpty()) {
+        const int base_index { base_->slot_list_.at(base_->FindSlot(string, hash)).index };
+        if (base_index >= 0)
+            return base_index;
+    }
+
+    if (slot_list_.isEmpty())
+        Rehash(kMinSlotCount);
+
+    const qsizetype slot { FindSlot(string, hash) };
+
+    const int index { slot_list_.at(slot).index };
+    return base_count_ + (index < 0 ? Insert(string, hash, slot) : index);
 }
 
-void SharedString::SetSharedString(const QString& string)
+/*!
+ * Returns the index of \a string, or -1 if it is not in the table.
+ */
+int SharedString::GetSharedStringIndex(QStringView string) const
 {
-    auto it = string_index_hash_.find(string);
+    const QByteArray utf8 { string.toUtf8() };
 
-    // If string does not exist, create new entry
-    if (it == string_index_hash_.end()) {
-        int index = string_list_.size();
+    if (base_) {
+        const int base_index { base_->GetSharedStringIndex(string) };
+        if (base_index >= 0)
+            return base_index;
+    }
 
-        string_list_.append(string);
-        it = string_index_hash_.insert(string, index);
+    // A lazily loaded table has no index yet, a scan is cheaper than decoding and indexing it all.
+    if (!lazy_source_.isNull()) {
+        for (int index = 0; index != span_list_.size(); ++index) {
+            if (GetView(index) == utf8)
+                return base_count_ + index;
+        }
+
+        return -1;
     }
 
-    // Optional usage tracking
-    string_count_hash_[string] += 1;
+    if (slot_list_.isEmpty())
+        return -1;
+
+    const int index { slot_list_.at(FindSlot(utf8, qHash(QByteArrayView(utf8)))).index };
+    return index < 0 ? -1 : base_count_ + index;
 }
 
 void SharedString::IncrementReference(int index)
 {
-    if (index < 0 || index >= string_list_.size()) {
+    if (index < 0 || index >= Count()) {
+        qDebug() << Q_FUNC_INFO << "SharedStrings: invalid index";
+        return;
+    }
+
+    // Strings of the base table are counted when the overlay is merged.
+    if (index >= base_count_)
+        ++reference_list_[index - base_count_];
+}
+
+void SharedString::DecrementReference(int index)
+{
+    if (index < 0 || index >= Count()) {
         qDebug() << Q_FUNC_INFO << "SharedStrings: invalid index";
         return;
     }
 
-    string_count_hash_[string_list_.at(index)] += 1;
+    if (index < base_count_)
+        return;
+
+    // A string stays in the table at zero references until the next Compact().
+    if (reference_list_.at(index - base_count_) > 0)
+        --reference_list_[index - base_count_];
 }
 
 QString SharedString::GetSharedString(int index) const
 {
-    if (index < 0 || index >= string_list_.size()) {
+    if (index < 0 || index >= Count()) {
+        qDebug() << Q_FUNC_INFO << "SharedStrings: invalid index";
+        return {};
+    }
+
+    return QString::fromUtf8(GetSharedStringView(index));
+}
+
+QByteArray SharedString::GetSharedStringUtf8(int index) const
+{
+    if (index < 0 || index >= Count()) {
         qDebug() << Q_FUNC_INFO << "SharedStrings: invalid index";
         return {};
     }
 
-    return string_list_[index];
+    return GetSharedStringView(index).toByteArray();
+}
+
+/*!
+ * Keeps the strings whose entry in \a count_list is positive and renumbers them densely,
+ * in table order or, if \a order_by_frequency is true, most used first. Duplicated items are merged.
+ * The counts become the new reference counts.
+ *
+ * Returns the map from old to new index, -1 for a dropped string. An empty map means the indices are unchanged.
+ */
+QList<int> SharedString::Compact(const QList<int>& count_list, bool order_by_frequency)
+{
+    Q_ASSERT(count_list.size() == Count());
+
+    Materialize();
+
+    const bool all_live { std::all_of(count_list.cbegin(), count_list.cend(), [](int count) { return count > 0; }) };
+    if (!base_ && !order_by_frequency && all_live && slot_used_ == span_list_.size()) {
+        reference_list_ = count_list;
+        return {};
+    }
+
+    SharedString source { OperationMode::kCreateNew };
+    Swap(source);
+    return Merge(source, count_list, order_by_frequency);
+}
+
+/*!
+ * Adds the strings of \a source whose entry in \a count_list is positive, with the counts as references,
+ * in the order of \a source or, if \a order_by_frequency is true, most used first.
+ *
+ * Returns the map from the indices of \a source to the indices of this table, -1 for a skipped string.
+ */
+QList<int> SharedString::Merge(const SharedString& source, const QList<int>& count_list, bool order_by_frequency)
+{
+    Q_ASSERT(count_list.size() == source.Count());
+
+    Materialize();
+
+    const int source_count { static_cast<int>(source.Count()) };
+
+    QList<int> order {};
+    order.reserve(source_count);
+    for (int index = 0; index != source_count; ++index) {
+        if (count_list.at(index) > 0)
+            order.append(index);
+    }
+
+    if (order_by_frequency)
+        std::stable_sort(order.begin(), order.end(), [&count_list](int lhs, int rhs) { return count_list.at(lhs) > count_list.at(rhs); });
+
+    Reserve(span_list_.size() + order.size());
+
+    QList<int> remap(source_count, -1);
+    for (int source_index : order) {
+        const int index { Intern(source.GetSharedStringView(source_index)) };
+
+        if (index >= base_count_)
+            reference_list_[index - base_count_] += count_list.at(source_index);
+
+        remap[source_index] = index;
+    }
+
+    return remap;
+}
+
+void SharedString::Swap(SharedString& other)
+{
+    Materialize();
+    other.Materialize();
+
+    arena_.swap(other.arena_);
+    span_list_.swap(other.span_list_);
+    slot_list_.swap(other.slot_list_);
+    std::swap(slot_used_, other.slot_used_);
+    reference_list_.swap(other.reference_list_);
+    base_.swap(other.base_);
+    std::swap(base_count_, other.base_count_);
+
+    generation_ = NextGeneration();
+    other.generation_ = NextGeneration();
+}
+
+void SharedString::Reserve(qsizetype count)
+{
+    span_list_.reserve(count);
+    reference_list_.reserve(count);
+
+    if (count * 2 > slot_list_.size())
+        Rehash(count * 2);
+}
+
+/*!
+ * Appends the UTF-8 \a string as a new item, as read from xl/sharedStrings.xml.
+ * A duplicated item keeps its own index for the cells that use it, lookups find the first one.
+ */
+int SharedString::Append(QByteArrayView string)
+{
+    Materialize();
+
+    if (slot_list_.isEmpty())
+        Rehash(kMinSlotCount);
+
+    const size_t hash { qHash(string) };
+    return base_count_ + Insert(string, hash, FindSlot(string, hash));
+}
+
+/*!
+ * Stores \a string at the end of the arena and claims \a slot if it is free.
+ * Returns its position in span_list_.
+ */
+int SharedString::Insert(QByteArrayView string, size_t hash, qsizetype slot)
+{
+    const int index { static_cast<int>(span_list_.size()) };
+
+    span_list_.append({ arena_.size(), string.size() });
+    arena_.append(string);
+    reference_list_.append(0);
+
+    if (slot_list_.at(slot).index < 0) {
+        slot_list_[slot] = { hash, index };
+
+        if (++slot_used_ * 2 > slot_list_.size())
+            Rehash(slot_list_.size() * 2);
+    }
+
+    return index;
+}
+
+/*!
+ * Returns the slot holding \a string, or the free slot where it belongs.
+ */
+qsizetype SharedString::FindSlot(QByteArrayView string, size_t hash) const
+{
+    const size_t mask { static_cast<size_t>(slot_list_.size() - 1) };
+    size_t slot { hash & mask };
+
+    // The table is at most half full, so probing always reaches a free slot.
+    while (true) {
+        const Slot& entry { slot_list_.at(static_cast<qsizetype>(slot)) };
+        if (entry.index < 0 || (entry.hash == hash && GetView(entry.index) == string))
+            return static_cast<qsizetype>(slot);
+
+        slot = (slot + 1) & mask;
+    }
+}
+
+void SharedString::Rehash(qsizetype capacity)
+{
+    qsizetype slot_count { kMinSlotCount };
+    while (slot_count < capacity)
+        slot_count *= 2;
+
+    const QList<Slot> old_list { std::exchange(slot_list_, QList<Slot>(slot_count)) };
+    const size_t mask { static_cast<size_t>(slot_count - 1) };
+
+    for (const Slot& entry : old_list) {
+        if (entry.index < 0)
+            continue;
+
+        size_t slot { entry.hash & mask };
+        while (slot_list_.at(static_cast<qsizetype>(slot)).index >= 0)
+            slot = (slot + 1) & mask;
+
+        slot_list_[static_cast<qsizetype>(slot)] = entry;
+    }
+}
+
+/*!
+ * Rebuilds the index from the arena, the first of duplicated items wins.
+ */
+void SharedString::RebuildIndex()
+{
+    slot_list_.clear();
+    slot_used_ = 0;
+    Rehash(span_list_.size() * 2);
+
+    const int count { static_cast<int>(span_list_.size()) };
+    for (int index = 0; index != count; ++index) {
+        const QByteArrayView string { GetView(index) };
+        const size_t hash { qHash(string) };
+        const qsizetype slot { FindSlot(string, hash) };
+
+        if (slot_list_.at(slot).index < 0) {
+            slot_list_[slot] = { hash, index };
+            ++slot_used_;
+        }
+    }
 }
 
+/*!
+ * Writes the part directly as UTF-8 bytes: each string is scanned once, and strings without
+ * markup characters are copied from the arena as they are.
+ */
 void SharedString::ComposeXml(QIODevice* device) const
 {
-    QXmlStreamWriter writer(device);
+    // Overlays are merged into a plain table before saving.
+    Q_ASSERT(!base_);
 
-    if (string_list_.size() != string_index_hash_.size()) {
+    if (span_list_.size() != slot_used_) {
         qDebug("Warning: Duplicated string items exist in shared_string_list_.");
     }
 
-    // Initialize XML document
-    writer.writeStartDocument(QLatin1String("1.0"), true);
-
     // Calculate the total reference count
-    int total_count { 0 };
-    for (auto it = string_count_hash_.cbegin(); it != string_count_hash_.cend(); ++it) {
-        total_count += it.value();
+    qint64 total_count { 0 };
+    for (int count : reference_list_) {
+        total_count += count;
     }
 
-    // Write root element <sst>
-    writer.writeStartElement(QLatin1String("sst"));
-    writer.writeAttribute(QLatin1String("xmlns"), QLatin1String("http://schemas.openxmlformats.org/spreadsheetml/2006/main"));
-    writer.writeAttribute(QLatin1String("count"), QString::number(total_count));
-    writer.writeAttribute(QLatin1String("uniqueCount"), QString::number(string_list_.size()));
+    QByteArray xml {};
+    xml.reserve(kFlushSize + 1024);
+
+    // Initialize XML document and write root element <sst>
+    xml.append(R"(<?xml version="1.0" encoding="UTF-8" standalone="yes"?>)");
+    xml.append(R"(<sst xmlns="http://schemas.openxmlformats.org/spreadsheetml/2006/main" count=")");
+    xml.append(QByteArray::number(total_count));
+    xml.append(R"(" uniqueCount=")");
+    xml.append(QByteArray::number(span_list_.size()));
+    xml.append(R"(">)");
 
     // Write each shared string
-    for (const QString& string : string_list_) {
-        writer.writeStartElement(QLatin1String("si"));
-        writer.writeStartElement(QLatin1String("t"));
+    const int count { static_cast<int>(span_list_.size()) };
+    for (int index = 0; index != count; ++index) {
+        const QByteArrayView string { GetView(index) };
+        const TextScan scan { Utility::ScanText(string) };
 
         // Add xml:space attribute if needed
-        if (Utility::IsSpacePreserveNeeded(string)) {
-            writer.writeAttribute(QLatin1String("http://www.w3.org/XML/1998/namespace"), QLatin1String("space"), QLatin1String("preserve"));
+        xml.append(scan.needs_space_preserve ? R"(<si><t xml:space="preserve">)" : "<si><t>");
+
+        if (scan.needs_escape)
+            Utility::AppendEscaped(xml, string);
+        else
+            xml.append(string);
+
+        xml.append("</t></si>");
+
+        if (xml.size() >= kFlushSize) {
+            device->write(xml);
+            xml.resize(0);
         }
-        writer.writeCharacters(string);
-        writer.writeEndElement(); // </t>
-        writer.writeEndElement(); // </si>
     }
 
-    writer.writeEndElement(); // </sst>
-    writer.writeEndDocument();
+    xml.append("</sst>");
+    device->write(xml);
 }
 
 void SharedString::ParseSharedString(QXmlStreamReader& reader)
+{
+    // IMPORTANT: even empty string is valid sharedString
+    Append(ReadItem(reader).toUtf8());
+}
+
+QString SharedString::ReadItem(QXmlStreamReader& reader)
 {
     Q_ASSERT(reader.name() == QStringLiteral("si"));
 
@@ -135,10 +535,183 @@ void SharedString::ParseSharedString(QXmlStreamReader& reader)
         }
     }
 
-    // IMPORTANT: even empty string is valid sharedString
-    const auto index { string_list_.size() };
-    string_list_.append(string);
-    string_index_hash_.insert(string, index);
+    return string;
+}
+
+MemoryFootprint SharedString::MemoryUsage() const
+{
+    MemoryFootprint footprint {};
+    footprint.shared_string = Utility::HeapSize(arena_) + Utility::HeapSize(span_list_) + Utility::HeapSize(slot_list_) + Utility::HeapSize(reference_list_)
+        + Utility::HeapSize(lazy_offset_list_);
+    footprint.cached_part = Utility::HeapSize(lazy_source_);
+
+    return footprint;
+}
+
+/*!
+ * Records where each <si> starts, plain items are copied as UTF-8 bytes without going through
+ * QString. In lazy mode items are decoded on first access, otherwise all at once right away.
+ * The byte scan only knows an unprefixed UTF-8 <sst> root, other parts go through ParseXml().
+ */
+bool SharedString::ParseByteArray(const QByteArray& data)
+{
+    YXLSX_TRACE_SCOPE("SharedString::ParseByteArray", xml_path_);
+
+    if (!HasPlainRoot(data))
+        return AbstractOOXmlFile::ParseByteArray(data);
+
+    const bool ok { ScanXml(data) };
+
+    if (!lazy_) {
+        Materialize();
+
+        if (span_list_.size() != slot_used_) {
+            qDebug("Warning: Duplicated items exist in shared string table.");
+        }
+    }
+
+    return ok;
+}
+
+bool SharedString::ScanXml(const QByteArray& data)
+{
+    const qsizetype sst_end { data.lastIndexOf("</sst>") };
+    if (sst_end < 0) {
+        qDebug("Error: Failed to read XML: missing </sst>.");
+        return false;
+    }
+
+    QList<qsizetype> offset_list {};
+    qsizetype pos { data.indexOf("<sst") };
+
+    // uniqueCount, if the writer gave one, must match the items found, as in ParseXml().
+    const qsizetype sst_tag_end { data.indexOf('>', pos) };
+    if (pos < 0 || sst_tag_end < 0) {
+        qDebug("Error: Failed to read XML: missing <sst>.");
+        return false;
+    }
+
+    const QByteArrayView sst_tag { QByteArrayView(data).sliced(pos, sst_tag_end - pos) };
+    const qsizetype unique_pos { sst_tag.indexOf("uniqueCount=") };
+    qsizetype unique_count { -1 };
+
+    if (unique_pos >= 0) {
+        const QByteArrayView value { sst_tag.sliced(unique_pos + 12) };
+        const qsizetype value_end { value.size() > 1 ? value.sliced(1).indexOf(value.front()) : -1 };
+
+        bool ok { false };
+        if (value_end >= 0)
+            unique_count = value.sliced(1, value_end).toLongLong(&ok);
+
+        if (!ok) {
+            qDebug("Error: Failed to parse 'uniqueCount' attribute.");
+            return false;
+        }
+    }
+
+    while ((pos = data.indexOf("<si", pos)) >= 0 && pos < sst_end) {
+        // Skip longer tag names that start with "si"
+        const char next { data.at(pos + 3) };
+        if (next == '>' || next == '/' || next == ' ' || next == '\t' || next == '\r' || next == '\n')
+            offset_list.append(pos);
+
+        pos += 3;
+    }
+
+    offset_list.append(sst_end);
+
+    const qsizetype count { offset_list.size() - 1 };
+    span_list_ = QList<Span>(count, Span { -1, 0 });
+    reference_list_ = QList<int>(count, 0);
+    lazy_source_ = data;
+    lazy_offset_list_ = std::move(offset_list);
+    generation_ = NextGeneration();
+
+    // The items are kept either way, as ParseXml() keeps those it read.
+    if (unique_count >= 0 && count != unique_count) {
+        qDebug("Error: Shared string count mismatch. Expected %lld, found %lld.", unique_count, count);
+        return false;
+    }
+
+    return true;
+}
+
+/*!
+ * Decodes the lazily loaded item at \a index and appends it to the arena.
+ */
+void SharedString::Decode(int index) const
+{
+    const qsizetype begin { lazy_offset_list_.at(index) };
+    const qsizetype end { lazy_offset_list_.at(index + 1) };
+
+    const QByteArrayView xml { QByteArrayView(lazy_source_).sliced(begin, end - begin) };
+
+    QByteArrayView text {};
+    if (ReadPlainItem(xml, text)) {
+        span_list_[index] = { arena_.size(), text.size() };
+        arena_.append(text);
+        return;
+    }
+
+    QXmlStreamReader reader(QByteArray::fromRawData(xml.data(), xml.size()));
+
+    QByteArray string {};
+    if (reader.readNextStartElement() && reader.name() == QStringLiteral("si"))
+        string = ReadItem(reader).toUtf8();
+
+    span_list_[index] = { arena_.size(), string.size() };
+    arena_.append(string);
+}
+
+/*!
+ * Sets \a text to the bytes of a plain item, <si><t>text</t></si>, with no markup, entity or
+ * carriage return inside. Returns false for anything the XML reader has to decode.
+ */
+bool SharedString::ReadPlainItem(QByteArrayView xml, QByteArrayView& text)
+{
+    static constexpr QByteArrayView kOpen { "<si><t>" };
+    static constexpr QByteArrayView kOpenPreserve { "<si><t xml:space=\"preserve\">" };
+    static constexpr QByteArrayView kClose { "</t></si>" };
+
+    xml = xml.trimmed();
+    if (!xml.endsWith(kClose))
+        return false;
+
+    qsizetype open_size {};
+    if (xml.startsWith(kOpen))
+        open_size = kOpen.size();
+    else if (xml.startsWith(kOpenPreserve))
+        open_size = kOpenPreserve.size();
+    else
+        return false;
+
+    if (xml.size() < open_size + kClose.size())
+        return false;
+
+    text = xml.sliced(open_size, xml.size() - open_size - kClose.size());
+    return !text.contains('<') && !text.contains('&') && !text.contains('\r');
+}
+
+void SharedString::DecodeAll() const
+{
+    for (int index = 0; index != span_list_.size(); ++index) {
+        if (span_list_.at(index).offset < 0)
+            Decode(index);
+    }
+}
+
+/*!
+ * Decodes every lazily loaded item and builds the index, before the table is written to.
+ */
+void SharedString::Materialize()
+{
+    if (lazy_source_.isNull())
+        return;
+
+    DecodeAll();
+    lazy_source_ = QByteArray();
+    lazy_offset_list_ = {};
+    RebuildIndex();
 }
 
 bool SharedString::ParseXml(QIODevice* device)
@@ -157,6 +730,11 @@ bool SharedString::ParseXml(QIODevice* device)
                     qDebug("Error: Failed to parse 'uniqueCount' attribute.");
                     return false;
                 }
+
+                // uniqueCount comes from the writer, the part size caps it: the smallest entry, <si/>, takes 5 bytes.
+                const qsizetype reserve_count { std::min<qint64>(unique_count, device->size() / 5) };
+                if (reserve_count > 0)
+                    Reserve(reserve_count);
             }
             // Let the loop descend into <sst>'s children
         } else if (reader.name() == QStringLiteral("si")) {
@@ -173,15 +751,16 @@ bool SharedString::ParseXml(QIODevice* device)
     }
 
     // Validate uniqueCount if attribute was present
-    if (has_unique_count_attr && string_list_.size() != unique_count) {
-        qDebug("Error: Shared string count mismatch. Expected %lld, found %lld.", unique_count, string_list_.size());
+    if (has_unique_count_attr && span_list_.size() != unique_count) {
+        qDebug("Error: Shared string count mismatch. Expected %lld, found %lld.", unique_count, span_list_.size());
         return false;
     }
 
-    if (string_list_.size() != string_index_hash_.size()) {
+    if (span_list_.size() != slot_used_) {
         qDebug("Warning: Duplicated items exist in shared string table.");
     }
 
+    generation_ = NextGeneration();
     return true;
 }
 
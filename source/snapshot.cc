@@ -0,0 +1,372 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "snapshot.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+
+#include "document.h"
+#include "utility.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+namespace {
+
+constexpr quint32 kSnapshotMagic { 0x5958534E }; // "YXSN"
+constexpr quint16 kSnapshotVersion { 3 };
+constexpr qint64 kFingerprintTail { 64 * 1024 };
+constexpr QDataStream::Version kStreamVersion { QDataStream::Qt_6_0 };
+
+}
+
+/*!
+ * Returns the key a snapshot of \a xlsx_name is valid for, or an empty array if the file cannot be read.
+ */
+QByteArray Snapshot::Fingerprint(const QString& xlsx_name)
+{
+    QFile file(xlsx_name);
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    const qint64 size { file.size() };
+    const qint64 mtime { file.fileTime(QFileDevice::FileModificationTime).toMSecsSinceEpoch() };
+
+    // The zip central directory sits at the end of the file and holds the CRC-32 of every part,
+    // so hashing the tail catches content changes that keep both size and mtime.
+    const qint64 tail { qMin(size, kFingerprintTail) };
+    if (!file.seek(size - tail))
+        return {};
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(file.read(tail));
+
+    QByteArray fingerprint {};
+    QDataStream stream(&fingerprint, QIODevice::WriteOnly);
+    stream << size << mtime << hash.result();
+    return fingerprint;
+}
+
+bool Snapshot::Save(const QString& xlsx_name, const Document& document)
+{
+    const QByteArray fingerprint { Fingerprint(xlsx_name) };
+    if (fingerprint.isEmpty() || !document.workbook_)
+        return false;
+
+    QSaveFile file(SnapshotPath(xlsx_name));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Failed to open snapshot for writing:" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(kStreamVersion);
+
+    stream << kSnapshotMagic << kSnapshotVersion << fingerprint;
+    stream << document.document_property_hash_;
+    stream << (document.content_type_ ? document.content_type_->ComposeByteArray() : QByteArray());
+    SaveWorkbook(stream, *document.workbook_);
+
+    if (stream.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool Snapshot::Load(const QString& xlsx_name, Document& document)
+{
+    QFile file(SnapshotPath(xlsx_name));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly) || file.size() == 0)
+        return false;
+
+    uchar* memory { file.map(0, file.size()) };
+    if (!memory)
+        return false;
+
+    bool ok { false };
+    {
+        // The mapping is read in place, only what the workbook keeps is copied out of it.
+        const QByteArray data { QByteArray::fromRawData(reinterpret_cast<const char*>(memory), file.size()) };
+        QDataStream stream(data);
+        stream.setVersion(kStreamVersion);
+        ok = LoadDocument(stream, xlsx_name, document);
+    }
+
+    file.unmap(memory);
+    return ok;
+}
+
+bool Snapshot::LoadDocument(QDataStream& stream, const QString& xlsx_name, Document& document)
+{
+    quint32 magic {};
+    quint16 version {};
+    stream >> magic >> version;
+
+    if (magic != kSnapshotMagic || version != kSnapshotVersion)
+        return false;
+
+    QByteArray fingerprint {};
+    stream >> fingerprint;
+
+    if (fingerprint.isEmpty() || fingerprint != Fingerprint(xlsx_name))
+        return false;
+
+    QHash<QString, QString> property_hash {};
+    QByteArray content_type {};
+    stream >> property_hash >> content_type;
+
+    auto workbook { QSharedPointer<Workbook>::create(OperationMode::kLoadExisting) };
+    if (!LoadWorkbook(stream, *workbook) || stream.status() != QDataStream::Ok) {
+        qWarning() << "Ignoring damaged snapshot:" << SnapshotPath(xlsx_name);
+        return false;
+    }
+
+    document.content_type_ = QSharedPointer<ContentType>::create(OperationMode::kLoadExisting);
+    document.content_type_->ParseByteArray(content_type);
+    document.document_property_hash_ = property_hash;
+    document.workbook_ = workbook;
+    document.is_load_xlsx_ = true;
+    return true;
+}
+
+void Snapshot::SaveWorkbook(QDataStream& stream, const Workbook& workbook)
+{
+    stream << qint32(workbook.x_window_) << qint32(workbook.y_window_) << qint32(workbook.window_width_) << qint32(workbook.window_height_)
+           << qint32(workbook.current_sheet_index_) << qint32(workbook.last_sheet_id_);
+
+    stream << qint32(workbook.defined_name_list_.size());
+    for (const DefinedName& name : workbook.defined_name_list_)
+        stream << name.name << name.formula << name.comment << qint32(name.sheet_id);
+
+    // The arena is written as one string, the spans and reference counts follow in table order.
+    const SharedString& shared_string { *workbook.shared_string_ };
+    shared_string.DecodeAll();
+    stream << shared_string.arena_ << qint32(shared_string.span_list_.size());
+    for (qsizetype index = 0; index != shared_string.span_list_.size(); ++index) {
+        const auto& span { shared_string.span_list_.at(index) };
+        stream << qint64(span.offset) << qint64(span.size) << qint32(shared_string.reference_list_.at(index));
+    }
+
+    stream << qint32(workbook.sheet_list_.size());
+    for (const auto& sheet : workbook.sheet_list_) {
+        stream << sheet->GetSheetName() << qint32(sheet->GetSheetId()) << static_cast<qint32>(sheet->GetSheetType()) << sheet->GetXmlPath();
+        SaveWorksheet(stream, *sheet.staticCast<Worksheet>());
+    }
+}
+
+bool Snapshot::LoadWorkbook(QDataStream& stream, Workbook& workbook)
+{
+    qint32 current_sheet_index {};
+    qint32 last_sheet_id {};
+    stream >> workbook.x_window_ >> workbook.y_window_ >> workbook.window_width_ >> workbook.window_height_ >> current_sheet_index >> last_sheet_id;
+
+    qint32 name_count {};
+    stream >> name_count;
+    if (name_count < 0)
+        return false;
+
+    for (qint32 i = 0; i != name_count && stream.status() == QDataStream::Ok; ++i) {
+        DefinedName name {};
+        qint32 sheet_id {};
+        stream >> name.name >> name.formula >> name.comment >> sheet_id;
+        name.sheet_id = sheet_id;
+        workbook.defined_name_list_.append(name);
+    }
+
+    SharedString& shared_string { *workbook.shared_string_ };
+    stream >> shared_string.arena_;
+
+    // Every entry takes 20 bytes, a larger count means a damaged file.
+    qint32 string_count {};
+    stream >> string_count;
+    if (string_count < 0 || string_count > stream.device()->bytesAvailable() / 20)
+        return false;
+
+    shared_string.span_list_.reserve(string_count);
+    shared_string.reference_list_.reserve(string_count);
+
+    const qint64 arena_size { shared_string.arena_.size() };
+    for (qint32 index = 0; index != string_count && stream.status() == QDataStream::Ok; ++index) {
+        qint64 offset {};
+        qint64 size {};
+        qint32 count {};
+        stream >> offset >> size >> count;
+
+        if (offset < 0 || size < 0 || offset > arena_size - size)
+            return false;
+
+        shared_string.span_list_.append({ offset, size });
+        shared_string.reference_list_.append(count);
+    }
+
+    shared_string.RebuildIndex();
+
+    qint32 sheet_count {};
+    stream >> sheet_count;
+    if (sheet_count < 0)
+        return false;
+
+    for (qint32 i = 0; i != sheet_count; ++i) {
+        QString name {};
+        qint32 sheet_id {};
+        qint32 type {};
+        QString xml_path {};
+        stream >> name >> sheet_id >> type >> xml_path;
+
+        auto sheet { workbook.LoadSheet(name, sheet_id, static_cast<SheetType>(type)) };
+        if (stream.status() != QDataStream::Ok || !sheet)
+            return false;
+
+        sheet->SetXmlPath(xml_path);
+        if (!LoadWorksheet(stream, *sheet.staticCast<Worksheet>()))
+            return false;
+    }
+
+    workbook.current_sheet_index_ = qBound(0, current_sheet_index, qMax(0, sheet_count - 1));
+    workbook.last_sheet_id_ = qMax(workbook.last_sheet_id_, last_sheet_id);
+    return stream.status() == QDataStream::Ok;
+}
+
+void Snapshot::SaveWorksheet(QDataStream& stream, const Worksheet& sheet)
+{
+    stream << sheet.dimension_.ComposeDimension();
+
+    stream << qint64(sheet.matrix_.CellCount());
+
+    for (const auto& [row, entry_list] : sheet.matrix_) {
+        for (const auto& entry : entry_list) {
+            const Cell& cell { entry.cell };
+            const bool valid { cell.value.isValid() };
+
+            stream << qint32(row) << qint32(entry.column) << static_cast<quint8>(cell.type) << valid;
+            if (!valid)
+                continue;
+
+            switch (cell.type) {
+            case CellType::kSharedString:
+                stream << qint32(cell.value.toInt());
+                break;
+            case CellType::kNumber:
+                stream << cell.value.toDouble();
+                break;
+            case CellType::kBoolean:
+                stream << cell.value.toBool();
+                break;
+            case CellType::kDateTime:
+                stream << cell.value.toDateTime();
+                break;
+            case CellType::kInlineString:
+                stream << cell.value.toByteArray();
+                break;
+            default:
+                stream << cell.value.toString();
+                break;
+            }
+        }
+    }
+}
+
+bool Snapshot::LoadWorksheet(QDataStream& stream, Worksheet& sheet)
+{
+    QString dimension {};
+    qint64 cell_count {};
+    stream >> dimension >> cell_count;
+
+    if (cell_count < 0)
+        return false;
+
+    if (!dimension.isEmpty()) {
+        sheet.dimension_ = Dimension(dimension);
+        sheet.matrix_.Reserve(sheet.dimension_.RowCount(), sheet.dimension_.ColumnCount());
+    }
+
+    for (qint64 i = 0; i != cell_count; ++i) {
+        qint32 row {};
+        qint32 column {};
+        quint8 type {};
+        bool valid {};
+        stream >> row >> column >> type >> valid;
+
+        if (stream.status() != QDataStream::Ok || !Utility::IsValidRowColumn(row, column) || type > static_cast<quint8>(CellType::kError))
+            return false;
+
+        const CellType cell_type { static_cast<CellType>(type) };
+        QVariant value {};
+
+        if (valid) {
+            switch (cell_type) {
+            case CellType::kSharedString: {
+                qint32 index {};
+                stream >> index;
+                if (index < 0 || index >= sheet.shared_string_->Count())
+                    return false;
+
+                value = index;
+                break;
+            }
+            case CellType::kNumber: {
+                double number {};
+                stream >> number;
+                value = number;
+                break;
+            }
+            case CellType::kBoolean: {
+                bool boolean {};
+                stream >> boolean;
+                value = boolean;
+                break;
+            }
+            case CellType::kDateTime: {
+                QDateTime date_time {};
+                stream >> date_time;
+                value = date_time;
+                break;
+            }
+            case CellType::kInlineString: {
+                QByteArray text {};
+                stream >> text;
+                value = text;
+                break;
+            }
+            default: {
+                QString text {};
+                stream >> text;
+                value = text;
+                break;
+            }
+            }
+        }
+
+        sheet.WriteMatrix(row, column, Cell { std::move(value), cell_type });
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+YXLSX_END_NAMESPACE
@@ -0,0 +1,151 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "streamrows.h"
+
+#include <QBuffer>
+#include <QDebug>
+
+#include "relationshipmgr.h"
+#include "rowreader.h"
+#include "sharedstring.h"
+#include "utility.h"
+#include "workbook.h"
+#include "zipreader.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+/*!
+ * Yields the tokenized rows of worksheet \a sheet_name in \a xlsx_name.
+ *
+ * The arguments are taken by value: the body first runs when the range is advanced,
+ * after the caller's arguments may be gone.
+ *
+ * The workbook, its relationships and the shared string table are loaded up front.
+ * The sheet part is inflated whole by the zip reader, but its rows are tokenized
+ * one at a time, each time the caller asks for the next one.
+ */
+Generator<RawRow> StreamRawRows(QString xlsx_name, QString sheet_name, LoadOptions options)
+{
+    ZipReader zip_reader(xlsx_name);
+    const QStringList& file_paths { zip_reader.GetFilePath() };
+
+    if (!file_paths.contains(QStringLiteral("_rels/.rels"))) {
+        qWarning() << "Failed to open the package:" << xlsx_name;
+        co_return;
+    }
+
+    RelationshipMgr root_rels {};
+    root_rels.ReadByteArray(zip_reader.GetFileData(QStringLiteral("_rels/.rels")));
+
+    QList<Relationship> rels_xl { root_rels.GetDocumentRelationship(QStringLiteral("/officeDocument")) };
+    if (rels_xl.isEmpty())
+        co_return;
+
+    const QString workbook_path { rels_xl[0].target };
+    const auto parts { Utility::SplitPath(workbook_path) };
+    const QString& workbook_dir { parts.first() };
+
+    Workbook workbook(OperationMode::kLoadExisting);
+    workbook.GetRelationship()->ReadByteArray(zip_reader.GetFileData(Utility::GetRelFilePath(workbook_path)));
+    workbook.SetXmlPath(workbook_path);
+    workbook.ParseByteArray(zip_reader.GetFileData(workbook_path));
+
+    const auto shared_string { workbook.GetSharedString() };
+    QList<Relationship> rels_shared_string { workbook.GetRelationship()->GetDocumentRelationship(QStringLiteral("/sharedStrings")) };
+    if (!rels_shared_string.isEmpty()) {
+        const QString name { rels_shared_string[0].target };
+        const QString path { (workbook_dir == QStringLiteral(".")) ? name : workbook_dir + QStringLiteral("/") + name };
+        shared_string->SetLazy(options.lazy_shared_string);
+        shared_string->ParseByteArray(zip_reader.GetFileData(path));
+    }
+
+    const auto sheet { workbook.GetSheet(sheet_name) };
+    if (!sheet) {
+        qWarning() << "Sheet not found:" << sheet_name;
+        co_return;
+    }
+
+    QByteArray data { zip_reader.GetFileData(sheet->GetXmlPath()) };
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+
+    RowReader row_reader(&buffer, options, shared_string.data());
+    if (!row_reader.ReadHeader())
+        co_return;
+
+    RawRow raw_row {};
+
+    while (row_reader.ReadRow(raw_row))
+        co_yield raw_row;
+
+    if (row_reader.HasError())
+        qWarning() << "XML Parsing Error:" << row_reader.ErrorString();
+}
+
+/*!
+ * Yields the rows of worksheet \a sheet_name in \a xlsx_name, decoded.
+ */
+Generator<StreamRow> StreamRows(QString xlsx_name, QString sheet_name, LoadOptions options)
+{
+    StreamRow row {};
+
+    for (const RawRow& raw_row : StreamRawRows(std::move(xlsx_name), std::move(sheet_name), std::move(options))) {
+        const SharedString* shared_string { raw_row.shared_string };
+
+        row.row = raw_row.row;
+        row.cells.clear();
+        row.cells.reserve(raw_row.cells.size());
+
+        for (const auto& raw_cell : raw_row.cells) {
+            QVariant value {};
+
+            if (!raw_cell.IsEmpty()) {
+                switch (raw_cell.type) {
+                case CellType::kSharedString: {
+                    const int index { raw_cell.SharedStringIndex() };
+                    if (shared_string && index >= 0 && index < shared_string->Count())
+                        value = shared_string->GetSharedString(index);
+                    break;
+                }
+                case CellType::kInlineString:
+                    value = QString::fromUtf8(raw_cell.utf8);
+                    break;
+                case CellType::kError:
+                    value = raw_cell.text;
+                    break;
+                default:
+                    value = RowReader::ParseValue(raw_cell.text, raw_cell.type);
+                    break;
+                }
+            }
+
+            row.cells.emplaceBack(StreamCell { raw_cell.column, raw_cell.type, std::move(value) });
+        }
+
+        co_yield row;
+    }
+}
+
+YXLSX_END_NAMESPACE
@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <algorithm>
+
+#include "tracescope.h"
+
+YXLSX_BEGIN_NAMESPACE
+
+namespace {
+
+struct TraceEvent {
+    const char* name {};
+    QString part {};
+    qint64 start_ns {};
+    qint64 end_ns {};
+    int thread {};
+};
+
+struct TraceState {
+    QMutex mutex {};
+    QString file_path {};
+    qint64 start_ns {}; // clock reading at Start(), spans are written relative to it
+    quint64 last_generation {};
+    QList<TraceEvent> event_list {};
+    int thread_count {};
+};
+
+TraceState& State()
+{
+    static TraceState state {};
+    return state;
+}
+
+// Started once and never restarted, so reading it needs no lock.
+const QElapsedTimer& Clock()
+{
+    static const QElapsedTimer clock { [] {
+        QElapsedTimer timer {};
+        timer.start();
+        return timer;
+    }() };
+
+    return clock;
+}
+
+// Threads are numbered in the order they first record a span, small ids read better in Perfetto.
+int ThreadId()
+{
+    thread_local int thread { -1 };
+    if (thread < 0) {
+        auto& state { State() };
+        QMutexLocker locker(&state.mutex);
+        thread = ++state.thread_count;
+    }
+
+    return thread;
+}
+
+} // namespace
+
+qint64 TraceRecorder::NowNs() { return Clock().nsecsElapsed(); }
+
+void TraceRecorder::Record(const char* name, const QString& part, quint64 generation, qint64 start_ns, qint64 end_ns)
+{
+    const int thread { ThreadId() };
+
+    auto& state { State() };
+    QMutexLocker locker(&state.mutex);
+
+    // A span that ends after Stop(), or in a trace started after it began, is dropped.
+    if (generation != Generation())
+        return;
+
+    state.event_list.emplaceBack(TraceEvent { name, part, std::max(start_ns, state.start_ns) - state.start_ns, end_ns - state.start_ns, thread });
+}
+
+/*!
+ * Starts recording spans, to be written to \a file_path by Stop().
+ * Returns false if tracing is not compiled in or a trace is already running.
+ */
+bool Trace::Start(const QString& file_path)
+{
+    if (!IsCompiledIn()) {
+        qWarning() << "Tracing is not compiled in, build with ENABLE_TRACE.";
+        return false;
+    }
+
+    auto& state { State() };
+    QMutexLocker locker(&state.mutex);
+
+    if (TraceRecorder::IsActive())
+        return false;
+
+    state.file_path = file_path;
+    state.event_list.clear();
+    state.start_ns = TraceRecorder::NowNs();
+    TraceRecorder::generation_.store(++state.last_generation, std::memory_order_release);
+    return true;
+}
+
+/*!
+ * Stops recording and writes the spans as trace-event JSON.
+ * Returns false if no trace was running or the file cannot be written.
+ */
+bool Trace::Stop()
+{
+    auto& state { State() };
+    QList<TraceEvent> event_list {};
+    QString file_path {};
+
+    {
+        QMutexLocker locker(&state.mutex);
+        if (!TraceRecorder::IsActive())
+            return false;
+
+        TraceRecorder::generation_.store(0, std::memory_order_release);
+        event_list.swap(state.event_list);
+        file_path = state.file_path;
+    }
+
+    const qint64 pid { QCoreApplication::applicationPid() };
+    QJsonArray trace_events {};
+
+    for (const auto& event : std::as_const(event_list)) {
+        QJsonObject object {
+            { QStringLiteral("name"), QLatin1String(event.name) },
+            { QStringLiteral("cat"), QStringLiteral("yxlsx") },
+            { QStringLiteral("ph"), QStringLiteral("X") },
+            { QStringLiteral("ts"), static_cast<double>(event.start_ns) / 1000.0 },
+            { QStringLiteral("dur"), static_cast<double>(event.end_ns - event.start_ns) / 1000.0 },
+            { QStringLiteral("pid"), pid },
+            { QStringLiteral("tid"), event.thread },
+        };
+
+        if (!event.part.isEmpty())
+            object.insert(QStringLiteral("args"), QJsonObject { { QStringLiteral("part"), event.part } });
+
+        trace_events.append(object);
+    }
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to write the trace:" << file_path;
+        return false;
+    }
+
+    file.write(QJsonDocument(QJsonObject { { QStringLiteral("traceEvents"), trace_events } }).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+bool Trace::IsCompiledIn()
+{
+#if defined(YXLSX_TRACE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+YXLSX_END_NAMESPACE
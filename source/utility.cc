@@ -26,9 +26,49 @@
 
 #include <QDebug>
 #include <QRegularExpression>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 YXLSX_BEGIN_NAMESPACE
 
+namespace {
+
+constexpr bool IsAsciiSpace(uchar c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+// Characters XML 1.0 does not allow, they are dropped when escaping.
+constexpr bool IsInvalidControl(uchar c) { return c < 0x20 && c != '\t' && c != '\n' && c != '\r'; }
+
+// Checks the first and last character, decoding them only when they are not ASCII.
+bool HasSpaceAtEnds(QByteArrayView s)
+{
+    if (IsAsciiSpace(static_cast<uchar>(s.front())) || IsAsciiSpace(static_cast<uchar>(s.back())))
+        return true;
+
+    if (static_cast<uchar>(s.front()) >= 0x80) {
+        const QString first { QString::fromUtf8(s.first(std::min<qsizetype>(4, s.size()))) };
+        if (!first.isEmpty() && first.front().isSpace())
+            return true;
+    }
+
+    if (static_cast<uchar>(s.back()) >= 0x80) {
+        // Walk back over continuation bytes to the lead byte of the last character.
+        qsizetype start { s.size() - 1 };
+        while (start > 0 && (static_cast<uchar>(s.at(start)) & 0xC0) == 0x80)
+            --start;
+
+        const QString last { QString::fromUtf8(s.sliced(start)) };
+        if (!last.isEmpty() && last.back().isSpace())
+            return true;
+    }
+
+    return false;
+}
+
+}
+
 QStringList Utility::SplitPath(const QString& path)
 {
     if (path.isEmpty())
@@ -130,17 +170,124 @@ QString Utility::UnescapeSheetName(const QString& sheetName)
 /*
  * Check whether the string `s` starts or ends with a space or whitespace character.
  */
-bool Utility::IsSpacePreserveNeeded(const QString& s)
+bool Utility::IsSpacePreserveNeeded(QStringView s)
 {
     // Early exit if the string is empty
     if (s.isEmpty())
         return false;
 
     // Check if the first or last character is a whitespace character
-    return s.front().isSpace() || s.back().isSpace() || s.contains(QStringLiteral("  "));
+    return s.front().isSpace() || s.back().isSpace() || s.contains(u"  ");
+}
+
+bool Utility::IsSpacePreserveNeeded(QByteArrayView s)
+{
+    return ScanText(s).needs_space_preserve;
+}
+
+/*!
+ * Scans the UTF-8 text \a s once and reports whether it needs escaping and xml:space="preserve".
+ * Uses SSE2, 16 bytes at a time, where available.
+ */
+TextScan Utility::ScanText(QByteArrayView s)
+{
+    TextScan scan {};
+    if (s.isEmpty())
+        return scan;
+
+    const char* data { s.data() };
+    const qsizetype size { s.size() };
+    qsizetype pos { 0 };
+    bool previous_space { false };
+
+#if defined(__SSE2__)
+    const __m128i less { _mm_set1_epi8('<') };
+    const __m128i greater { _mm_set1_epi8('>') };
+    const __m128i ampersand { _mm_set1_epi8('&') };
+    const __m128i space { _mm_set1_epi8(' ') };
+    const __m128i tab { _mm_set1_epi8('\t') };
+    const __m128i line_feed { _mm_set1_epi8('\n') };
+    const __m128i last_control { _mm_set1_epi8(0x1F) };
+
+    for (; pos + 16 <= size; pos += 16) {
+        const __m128i bytes { _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)) };
+
+        // Unsigned bytes <= 0x1F, except tab and line feed; carriage return is escaped too.
+        const __m128i control { _mm_andnot_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, tab), _mm_cmpeq_epi8(bytes, line_feed)), _mm_cmpeq_epi8(_mm_min_epu8(bytes, last_control), bytes)) };
+        const __m128i special { _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(bytes, less), _mm_cmpeq_epi8(bytes, greater)), _mm_or_si128(_mm_cmpeq_epi8(bytes, ampersand), control)) };
+
+        if (_mm_movemask_epi8(special) != 0)
+            scan.needs_escape = true;
+
+        const unsigned spaces { static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, space))) };
+        if ((spaces & (spaces >> 1)) != 0 || (previous_space && (spaces & 1u) != 0))
+            scan.needs_space_preserve = true;
+
+        previous_space = (spaces & 0x8000u) != 0;
+    }
+#endif
+
+    for (; pos < size; ++pos) {
+        const uchar c { static_cast<uchar>(data[pos]) };
+
+        if (c == '<' || c == '>' || c == '&' || (c < 0x20 && c != '\t' && c != '\n'))
+            scan.needs_escape = true;
+
+        const bool is_space { c == ' ' };
+        if (is_space && previous_space)
+            scan.needs_space_preserve = true;
+
+        previous_space = is_space;
+    }
+
+    if (!scan.needs_space_preserve)
+        scan.needs_space_preserve = HasSpaceAtEnds(s);
+
+    return scan;
+}
+
+/*!
+ * Appends the UTF-8 text \a s to \a xml as escaped character data.
+ */
+void Utility::AppendEscaped(QByteArray& xml, QByteArrayView s)
+{
+    qsizetype clean_begin { 0 };
+
+    for (qsizetype pos = 0; pos != s.size(); ++pos) {
+        const uchar c { static_cast<uchar>(s.at(pos)) };
+
+        const char* entity {};
+        switch (c) {
+        case '<':
+            entity = "&lt;";
+            break;
+        case '>':
+            entity = "&gt;";
+            break;
+        case '&':
+            entity = "&amp;";
+            break;
+        case '\r':
+            entity = "&#13;";
+            break;
+        default:
+            if (!IsInvalidControl(c))
+                continue;
+            entity = "";
+            break;
+        }
+
+        xml.append(s.sliced(clean_begin, pos - clean_begin));
+        xml.append(entity);
+        clean_begin = pos + 1;
+    }
+
+    xml.append(s.sliced(clean_begin));
 }
 
-CellAddress Utility::ParseCoordinate(const QString& coordinate)
+CellAddress Utility::ParseCoordinate(QStringView coordinate)
 {
     CellAddress result {};
 
@@ -25,6 +25,8 @@
 #include "workbook.h"
 
 #include <QDir>
+#include <QHash>
+#include <algorithm>
 
 #include "utility.h"
 
@@ -82,7 +84,7 @@ QSharedPointer<AbstractSheet> Workbook::InsertSheet(int index, const QString& na
 
     // Update sheet ID and create the sheet
     ++last_sheet_id_;
-    auto sheet { QSharedPointer<Worksheet>::create(sheet_name, last_sheet_id_, shared_string_, type) };
+    auto sheet { QSharedPointer<Worksheet>::create(sheet_name, last_sheet_id_, CreateSheetSharedString(), type) };
 
     // Insert the sheet and name into containers
     sheet_list_.insert(index, sheet);
@@ -185,6 +187,104 @@ bool Workbook::DeleteSheet(const QString& name)
     return DeleteSheet(index);
 }
 
+/*!
+ * Drops the shared strings no worksheet refers to any more, e.g. after overwriting cells or
+ * deleting sheets, and renumbers the rest densely. Document calls it before saving.
+ * Columns written with StringType::kAuto are decided first.
+ *
+ * Worksheets written in parallel hold their own tables; SetParallelWrite() merges them back into
+ * the workbook table here when parallel writing is disabled, and every worksheet shares it again.
+ */
+void Workbook::CompactSharedString()
+{
+    const auto worksheets { GetSheetByType(SheetType::kWorkSheet) };
+    const bool order_by_frequency { shared_string_order_ == StringOrder::kFrequency };
+
+    for (const auto& sheet : worksheets)
+        sheet.staticCast<Worksheet>()->ResolveAutoString();
+
+    const bool detached { std::any_of(worksheets.cbegin(), worksheets.cend(),
+        [this](const QSharedPointer<AbstractSheet>& sheet) { return sheet.staticCast<Worksheet>()->shared_string_ != shared_string_; }) };
+
+    if (!detached) {
+        QList<int> count_list(shared_string_->Count(), 0);
+        for (const auto& sheet : worksheets)
+            sheet.staticCast<Worksheet>()->CountSharedString(count_list);
+
+        const QList<int> remap { shared_string_->Compact(count_list, order_by_frequency) };
+        if (remap.isEmpty())
+            return;
+
+        for (const auto& sheet : worksheets)
+            sheet.staticCast<Worksheet>()->RemapSharedString(remap);
+
+        return;
+    }
+
+    // Merge table by table, worksheets sharing a table share its remap.
+    SharedString merged { OperationMode::kCreateNew };
+    QHash<const SharedString*, QList<int>> remap_hash {};
+
+    for (const auto& sheet : worksheets) {
+        const auto worksheet { sheet.staticCast<Worksheet>() };
+        const SharedString* table { worksheet->shared_string_.data() };
+
+        if (remap_hash.contains(table))
+            continue;
+
+        QList<int> count_list(table->Count(), 0);
+        for (const auto& other : worksheets) {
+            const auto other_worksheet { other.staticCast<Worksheet>() };
+            if (other_worksheet->shared_string_.data() == table)
+                other_worksheet->CountSharedString(count_list);
+        }
+
+        remap_hash.insert(table, merged.Merge(*table, count_list, false));
+    }
+
+    for (const auto& sheet : worksheets) {
+        const auto worksheet { sheet.staticCast<Worksheet>() };
+        worksheet->RemapSharedString(remap_hash.value(worksheet->shared_string_.data()));
+        worksheet->shared_string_ = shared_string_;
+    }
+
+    shared_string_->Swap(merged);
+
+    // The merged table is in first-use order, a second pass applies the requested order.
+    if (order_by_frequency)
+        CompactSharedString();
+}
+
+/*!
+ * Enables or disables parallel writing. While enabled, each worksheet writes its strings to its
+ * own table, so different worksheets can be filled from different threads without locking.
+ * A worksheet must not be written from two threads at once, and sheets must be added, removed
+ * or saved from one thread only. Saving is refused while it is enabled, disabling it merges the
+ * tables back.
+ */
+void Workbook::SetParallelWrite(bool enable)
+{
+    if (enable == parallel_write_)
+        return;
+
+    if (!enable) {
+        CompactSharedString();
+        parallel_write_ = false;
+        return;
+    }
+
+    // Existing cells keep referring to the workbook table, each worksheet only holds its new strings.
+    for (const auto& sheet : GetSheetByType(SheetType::kWorkSheet))
+        sheet.staticCast<Worksheet>()->shared_string_ = QSharedPointer<SharedString>::create(shared_string_);
+
+    parallel_write_ = true;
+}
+
+QSharedPointer<SharedString> Workbook::CreateSheetSharedString() const
+{
+    return parallel_write_ ? QSharedPointer<SharedString>::create(OperationMode::kCreateNew) : shared_string_;
+}
+
 /*!
  * Returns the sheet object at index \a sheetIndex.
  */
@@ -490,4 +590,26 @@ QString Workbook::ResolveFullPath(const QString& target, const QString& base_pat
     }
 }
 
+/*!
+ * Returns the heap held by the worksheets and the shared string tables.
+ * In parallel write mode each sheet table is counted once, beside the workbook's own.
+ */
+MemoryFootprint Workbook::MemoryUsage() const
+{
+    MemoryFootprint footprint { shared_string_->MemoryUsage() };
+
+    for (const auto& sheet : sheet_list_) {
+        const auto worksheet { sheet.dynamicCast<Worksheet>() };
+        if (!worksheet)
+            continue;
+
+        footprint += worksheet->MemoryUsage();
+
+        if (worksheet->shared_string_ != shared_string_)
+            footprint += worksheet->shared_string_->MemoryUsage();
+    }
+
+    return footprint;
+}
+
 YXLSX_END_NAMESPACE
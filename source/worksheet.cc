@@ -25,11 +25,36 @@
 #include "worksheet.h"
 
 #include <QDateTime>
+#include <algorithm>
 
+#include "cellcodec.h"
+#include "rowreader.h"
+#include "tracescope.h"
 #include "utility.h"
 
 YXLSX_BEGIN_NAMESPACE
 
+namespace {
+
+// A kAuto column is decided once this many strings were sampled,
+constexpr int kAutoSampleSize { 512 };
+// columns with fewer strings at save time stay shared.
+constexpr int kAutoMinSampleSize { 32 };
+// More distinct values than this share of the sample means sharing saves little.
+constexpr double kAutoInlineRatio { 0.5 };
+
+StringType DecideStringType(int distinct_count, int sample_count)
+{
+    if (sample_count < kAutoMinSampleSize)
+        return StringType::kSharedString;
+
+    return distinct_count > sample_count * kAutoInlineRatio ? StringType::kInlineString : StringType::kSharedString;
+}
+
+inline bool IsNull(const QBitArray& nulls, qsizetype index) { return index < nulls.size() && nulls.testBit(index); }
+
+}
+
 QString Worksheet::ComposeDimension() const
 {
     if (!dimension_.IsValid())
@@ -83,45 +108,27 @@ bool Worksheet::Write(int row, int column, const QVariant& data, StringType stri
     if (!UpdateDimension(row, column))
         return false;
 
-    const CellType cell_type { DetermineCellType(data, string_type) };
-
-    auto cell { QSharedPointer<Cell>::create(data, cell_type) };
-
-    if (cell_type == CellType::kSharedString) {
-        shared_string_->SetSharedString(data.toString());
-    }
-
-    WriteMatrix(row, column, cell);
+    matrix_.WriteRows(row, 1, [&](int, CellStore::RowWriter& writer) { WriteCell(writer, row, column, data, string_type); });
     return true;
 }
 
-CellType Worksheet::DetermineCellType(const QVariant& value, StringType string_type) const
+/*!
+ * \overload
+ * Moves \a data into the cell instead of copying it.
+ */
+bool Worksheet::Write(int row, int column, QVariant&& data, StringType string_type)
 {
-    if (!value.isValid())
-        return CellType::kEmpty;
-
-    switch (value.typeId()) {
-    case QMetaType::Bool:
-        return CellType::kBoolean;
-
-    case QMetaType::Int:
-    case QMetaType::UInt:
-    case QMetaType::LongLong:
-    case QMetaType::ULongLong:
-    case QMetaType::Double:
-    case QMetaType::Float:
-        return CellType::kNumber;
+    if (!Utility::IsValidRowColumn(row, column))
+        return false;
 
-    case QMetaType::QDateTime:
-        return CellType::kDateTime;
+    if (data.isNull())
+        return false;
 
-    case QMetaType::QString:
-        return string_type == StringType::kSharedString ? CellType::kSharedString : CellType::kInlineString;
+    if (!UpdateDimension(row, column))
+        return false;
 
-    default:
-        qWarning() << "Unsupported QVariant type:" << value.typeName();
-        return CellType::kSharedString; // Excel safest fallback
-    }
+    matrix_.WriteRows(row, 1, [&](int, CellStore::RowWriter& writer) { WriteCell(writer, row, column, std::move(data), string_type); });
+    return true;
 }
 
 /*!
@@ -140,6 +147,17 @@ bool Worksheet::Write(const Coordinate& coordinate, const QVariant& data, String
     return Write(coordinate.Row(), coordinate.Column(), data, string_type);
 }
 
+/*!
+ * \overload
+ */
+bool Worksheet::Write(const Coordinate& coordinate, QVariant&& data, StringType string_type)
+{
+    if (!coordinate.IsValid())
+        return false;
+
+    return Write(coordinate.Row(), coordinate.Column(), std::move(data), string_type);
+}
+
 /*!
  * \overload
  * Returns the value stored in the cell at the specified \a coordinate.
@@ -162,342 +180,453 @@ QVariant Worksheet::Read(const Coordinate& coordinate) const
 QVariant Worksheet::Read(int row, int column) const
 {
     // Retrieve the cell at the given position
-    auto cell { ReadMatrix(row, column) };
+    const Cell* cell { ReadMatrix(row, column) };
 
-    // Return the cell's value if it exists; otherwise, return an empty QVariant
-    return cell ? cell->value : QVariant();
+    return cell ? ReadCell(*cell) : QVariant();
 }
 
 /*!
-        Write a empty cell (\a row, \a column) with the \a format.
-        Returns true on success.
+ * \internal
+ * Returns the value of \a cell as Read() reports it, shared strings resolved through \a shared_string.
  */
-bool Worksheet::WriteBlank(int row, int column)
+QVariant Worksheet::ReadCell(const Cell& cell, const SharedString* shared_string)
 {
-    // Note: NumberType with an invalid QVariant value means blank.
-    auto cell { QSharedPointer<Cell>::create(QVariant {}, CellType::kNumber) };
-    WriteMatrix(row, column, cell);
-    return true;
+    if (cell.type == CellType::kSharedString && cell.value.isValid())
+        return shared_string ? shared_string->GetSharedString(cell.value.toInt()) : QVariant();
+
+    if (cell.type == CellType::kInlineString)
+        return QString::fromUtf8(cell.value.toByteArray());
+
+    return cell.value;
 }
 
 /*!
  * \internal
+ * Writes \a cell to the matrix. An overwritten shared string cell releases its string.
  */
-void Worksheet::ComposeXml(QIODevice* device) const
+void Worksheet::WriteMatrix(int row, int column, Cell cell)
 {
-    relationship_->Clear();
-    QXmlStreamWriter writer(device);
-    writer.writeStartDocument(QLatin1String("1.0"), true);
-    writer.writeStartElement(QLatin1String("worksheet"));
-    writer.writeAttribute(QLatin1String("xmlns"), QLatin1String("http://schemas.openxmlformats.org/spreadsheetml/2006/main"));
-    writer.writeAttribute(QLatin1String("xmlns:r"), QLatin1String("http://schemas.openxmlformats.org/officeDocument/2006/relationships"));
+    Cell replaced {};
+    matrix_.Write(row, column, std::move(cell), &replaced);
 
-    writer.writeStartElement(QLatin1String("dimension"));
-    writer.writeAttribute(QLatin1String("ref"), ComposeDimension());
-    writer.writeEndElement(); // dimension
+    if (replaced.type == CellType::kSharedString && replaced.value.isValid())
+        shared_string_->DecrementReference(replaced.value.toInt());
+}
 
-    writer.writeStartElement(QLatin1String("sheetViews"));
-    writer.writeStartElement(QLatin1String("sheetView"));
-    writer.writeAttribute(QLatin1String("workbookViewId"), QLatin1String("0"));
-    writer.writeEndElement(); // sheetView
-    writer.writeEndElement(); // sheetViews
+/*!
+ * \internal
+ * Writes \a cell at \a column of the row \a writer holds, as WriteMatrix() does.
+ */
+void Worksheet::StoreCell(CellStore::RowWriter& writer, int column, Cell cell)
+{
+    Cell replaced {};
+    writer.Write(column, std::move(cell), &replaced);
 
-    writer.writeStartElement(QLatin1String("sheetFormatPr"));
-    writer.writeAttribute(QLatin1String("defaultRowHeight"), QString::number(sheet_format_props_.default_row_height));
-    writer.writeAttribute(QLatin1String("defaultColWidth"), QString::number(sheet_format_props_.default_col_width));
-    writer.writeEndElement(); // sheetFormatPr
+    if (replaced.type == CellType::kSharedString && replaced.value.isValid())
+        shared_string_->DecrementReference(replaced.value.toInt());
+}
 
-    // -------------------
-    // Add column definitions for shrinkToFit to work
-    // -------------------
-    writer.writeStartElement(QLatin1String("cols"));
-    writer.writeStartElement(QLatin1String("col"));
-    writer.writeAttribute(QLatin1String("min"), QLatin1String("1"));
-    writer.writeAttribute(QLatin1String("max"), QLatin1String("16384")); // Excel max columns
-    writer.writeAttribute(QLatin1String("width"), QLatin1String("12"));
-    writer.writeAttribute(QLatin1String("customWidth"), QLatin1String("1"));
-    writer.writeEndElement(); // col
-    writer.writeEndElement(); // cols
+/*!
+ * \internal
+ * Writes \a value, shared string cells keep the index of the string, not the string itself.
+ */
+void Worksheet::WriteCell(CellStore::RowWriter& writer, int row, int column, QVariant value, StringType string_type)
+{
+    const CellType cell_type { CellCodec::DetermineCellType(value, string_type) };
 
-    writer.writeStartElement(QLatin1String("sheetData"));
-    if (dimension_.IsValid())
-        ComposeSheet(writer);
-    writer.writeEndElement(); // sheetData
+    switch (cell_type) {
+    case CellType::kEmpty:
+        return;
+    case CellType::kSharedString:
+        // Also the fallback for types without a cell type of their own.
+        WriteString(writer, row, column, value.toString(), string_type == StringType::kAuto ? string_type : StringType::kSharedString);
+        return;
+    case CellType::kInlineString:
+        WriteString(writer, row, column, value.toString(), string_type);
+        return;
+    default:
+        StoreCell(writer, column, Cell { std::move(value), cell_type });
+        return;
+    }
+}
 
-    writer.writeEndElement(); // worksheet
-    writer.writeEndDocument();
+/*!
+ * \internal
+ * Checks a bulk write of \a row_count rows by \a column_count columns from (\a row, \a column),
+ * and extends the dimension once.
+ */
+bool Worksheet::PrepareRange(int row, int column, qsizetype row_count, int column_count)
+{
+    if (row_count <= 0 || column_count <= 0) {
+        qWarning() << "Data is empty for bulk write.";
+        return false;
+    }
+
+    if (!Utility::IsValidRowColumn(row, column)) {
+        qWarning() << "Invalid first cell for bulk write:" << row << column;
+        return false;
+    }
+
+    if (row_count > kMaxExcelRow || column_count > kMaxExcelColumn) {
+        qWarning() << "Bulk write of" << row_count << "rows by" << column_count << "columns is larger than a sheet.";
+        return false;
+    }
+
+    // Both corners are checked before the dimension is touched, so a rejected write leaves it as it was.
+    const int end_row { row + static_cast<int>(row_count) - 1 };
+    const int end_column { column + column_count - 1 };
+    if (!Utility::IsValidRowColumn(end_row, end_column)) {
+        qWarning() << "Invalid last cell for bulk write:" << end_row << end_column;
+        return false;
+    }
+
+    UpdateDimension(row, column);
+    UpdateDimension(end_row, end_column);
+    return true;
 }
 
-void Worksheet::ComposeSheet(QXmlStreamWriter& writer) const
+/*!
+ * Writes \a values as number cells down from (\a row, \a column), skipping the rows set in \a nulls.
+ */
+bool Worksheet::WriteColumnSpan(int row, int column, std::span<const double> values, const QBitArray& nulls)
 {
-    for (auto row_it = matrix_.cbegin(); row_it != matrix_.cend(); ++row_it) {
-        const int row = row_it.key();
-        const auto& cols = row_it.value();
+    if (!PrepareColumn(row, column, static_cast<qsizetype>(values.size())))
+        return false;
 
-        if (cols.isEmpty())
-            continue;
+    matrix_.WriteRows(row, static_cast<int>(values.size()), [&](int current_row, CellStore::RowWriter& writer) {
+        const qsizetype i { current_row - row };
+        if (!IsNull(nulls, i))
+            StoreCell(writer, column, Cell { values[i], CellType::kNumber });
+    });
 
-        writer.writeStartElement(QStringLiteral("row"));
-        writer.writeAttribute(QStringLiteral("r"), QString::number(row));
-        writer.writeAttribute(QStringLiteral("spans"), QStringLiteral("%1:%2").arg(cols.firstKey()).arg(cols.lastKey()));
+    return true;
+}
 
-        for (auto col_it = cols.cbegin(); col_it != cols.cend(); ++col_it) {
-            const auto& cell = col_it.value();
-            if (cell && cell->value.isValid())
-                ComposeCell(writer, row, col_it.key(), cell);
-        }
+/*!
+ * \overload
+ */
+bool Worksheet::WriteColumnSpan(int row, int column, std::span<const qint64> values, const QBitArray& nulls)
+{
+    if (!PrepareColumn(row, column, static_cast<qsizetype>(values.size())))
+        return false;
 
-        writer.writeEndElement();
-    }
+    matrix_.WriteRows(row, static_cast<int>(values.size()), [&](int current_row, CellStore::RowWriter& writer) {
+        const qsizetype i { current_row - row };
+        if (!IsNull(nulls, i))
+            StoreCell(writer, column, Cell { values[i], CellType::kNumber });
+    });
+
+    return true;
 }
 
-void Worksheet::ComposeCell(QXmlStreamWriter& writer, int row, int col, const QSharedPointer<Cell>& cell) const
+/*!
+ * \overload
+ * Writes \a values as string cells, shared or inline as \a string_type says.
+ */
+bool Worksheet::WriteColumnSpan(int row, int column, std::span<const QStringView> values, const QBitArray& nulls, StringType string_type)
 {
-    Q_ASSERT(cell);
+    if (!PrepareColumn(row, column, static_cast<qsizetype>(values.size())))
+        return false;
 
-    // This is the innermost loop so efficiency is important.
-    const QString coord { Utility::ComposeCoordinate(row, col) };
+    matrix_.WriteRows(row, static_cast<int>(values.size()), [&](int current_row, CellStore::RowWriter& writer) {
+        const qsizetype i { current_row - row };
+        if (!IsNull(nulls, i))
+            WriteString(writer, current_row, column, values[i], string_type);
+    });
 
-    writer.writeStartElement(QLatin1String("c"));
-    writer.writeAttribute(QLatin1String("r"), coord);
+    return true;
+}
 
-    // -------------------
-    // Set style index to small font + shrinkToFit
-    // -------------------
-    writer.writeAttribute(QLatin1String("s"), QString::number(kDefaultStyleIndex)); // All cells use shrinkToFit style
+/*!
+ * \internal
+ * Writes \a text as a shared or inline string cell.
+ */
+void Worksheet::WriteString(CellStore::RowWriter& writer, int row, int column, QStringView text, StringType string_type)
+{
+    const bool is_auto { string_type == StringType::kAuto };
+    if (is_auto)
+        string_type = GetAutoStringType(column);
 
-    // Empty cell must still be written
-    if (cell->type == CellType::kEmpty) {
-        writer.writeEndElement();
+    // Inline strings are kept in UTF-8, as they are written.
+    if (string_type == StringType::kInlineString) {
+        StoreCell(writer, column, Cell { text.toUtf8(), CellType::kInlineString });
         return;
     }
 
-    switch (cell->type) {
-    case CellType::kSharedString: { // 's'
-        int shared_string_index { shared_string_->GetSharedStringIndex(cell->value.toString()) };
+    const int index { shared_string_->SetSharedString(text) };
+    StoreCell(writer, column, Cell { index, CellType::kSharedString });
 
-        if (shared_string_index < 0) {
-            qWarning() << "Missing shared string:" << cell->value.toString();
-            shared_string_index = 0; // or fallback safe value
-        }
+    if (is_auto)
+        SampleAutoString(row, column, index);
+}
 
-        writer.writeAttribute(QLatin1String("t"), QLatin1String("s"));
-        writer.writeTextElement(QLatin1String("v"), QString::number(shared_string_index));
-        break;
-    }
-    case CellType::kNumber: { // 'n'
-        writer.writeAttribute(QLatin1String("t"), QLatin1String("n"));
-        writer.writeTextElement(QLatin1String("v"), QString::number(cell->value.toDouble(), 'g', 15));
-        break;
-    }
-    case CellType::kBoolean: { // 'b'
-        writer.writeAttribute(QLatin1String("t"), QLatin1String("b"));
-        writer.writeTextElement(QLatin1String("v"), cell->value.toBool() ? QLatin1String("1") : QLatin1String("0"));
-        break;
-    }
-    case CellType::kDateTime: {
-        writer.writeAttribute(QLatin1String("t"), QLatin1String("d"));
-        writer.writeTextElement(QLatin1String("v"), cell->value.toDateTime().toString(Qt::ISODateWithMs));
-        break;
-    }
-    case CellType::kInlineString: { // 'inlineStr'
-        writer.writeAttribute(QLatin1String("t"), QLatin1String("inlineStr"));
+/*!
+ * \internal
+ * Returns how a kAuto string goes to \a column: shared while the column is sampled, then as decided.
+ */
+StringType Worksheet::GetAutoStringType(int column) const
+{
+    const auto it { auto_string_hash_.constFind(column) };
+    if (it == auto_string_hash_.cend() || it->type == StringType::kAuto)
+        return StringType::kSharedString;
+
+    return it->type;
+}
 
-        const QString text { cell->value.toString() };
+/*!
+ * \internal
+ * Records the kAuto string \a index written shared at (\a row, \a column) while the column is
+ * sampled. Once the sample is full the column is decided, and if it goes inline the sampled
+ * cells are turned into inline string cells.
+ */
+void Worksheet::SampleAutoString(int row, int column, int index)
+{
+    AutoStringColumn& auto_column { auto_string_hash_[column] };
+    if (auto_column.type != StringType::kAuto)
+        return;
 
-        writer.writeStartElement(QLatin1String("is"));
-        writer.writeStartElement(QLatin1String("t"));
+    auto_column.sample.insert(index);
+    auto_column.cell_list.append({ row, index });
+    if (++auto_column.sample_count < kAutoSampleSize)
+        return;
 
-        if (Utility::IsSpacePreserveNeeded(text)) {
-            writer.writeAttribute(QStringLiteral("http://www.w3.org/XML/1998/namespace"), QStringLiteral("space"), QStringLiteral("preserve"));
-        }
+    auto_column.type = DecideStringType(auto_column.sample.size(), auto_column.sample_count);
+    if (auto_column.type == StringType::kInlineString)
+        InlineAutoString(column, auto_column.cell_list);
 
-        writer.writeCharacters(text);
+    auto_column.sample = {};
+    auto_column.cell_list = {};
+}
 
-        writer.writeEndElement(); // </t>
-        writer.writeEndElement(); // </is>
+/*!
+ * \internal
+ * Turns the cells of \a column listed in \a cell_list into inline string cells. A cell that was
+ * overwritten since it was sampled no longer holds its shared string and is left as it is.
+ */
+void Worksheet::InlineAutoString(int column, const QList<std::pair<int, int>>& cell_list)
+{
+    for (const auto& [row, index] : cell_list) {
+        Cell* cell { matrix_.Read(row, column) };
+        if (!cell || cell->type != CellType::kSharedString || !cell->value.isValid() || cell->value.toInt() != index)
+            continue;
 
-        break;
+        *cell = Cell { shared_string_->GetSharedStringUtf8(index), CellType::kInlineString };
+        shared_string_->DecrementReference(index);
     }
-    default:
-        qWarning() << "Unsupported CellType";
-        break;
-    }
-
-    writer.writeEndElement();
 }
 
-void Worksheet::ParseSheet(QXmlStreamReader& reader)
+/*!
+ * \internal
+ * Decides the kAuto columns still sampled and turns their sampled cells into inline string cells
+ * if they go inline. Called before the shared strings are compacted, which then drops the strings
+ * only those cells used. Cells written with an explicit StringType are never converted.
+ */
+void Worksheet::ResolveAutoString()
 {
-    Q_ASSERT(reader.name() == QStringLiteral("sheetData"));
+    for (auto it = auto_string_hash_.begin(); it != auto_string_hash_.end(); ++it) {
+        AutoStringColumn& auto_column { it.value() };
+        if (auto_column.type != StringType::kAuto)
+            continue;
 
-    while (reader.readNextStartElement()) {
-        if (reader.name() == QStringLiteral("row")) {
-            ParseRow(reader);
-        } else {
-            reader.skipCurrentElement();
-        }
+        auto_column.type = DecideStringType(auto_column.sample.size(), auto_column.sample_count);
+        if (auto_column.type == StringType::kInlineString)
+            InlineAutoString(it.key(), auto_column.cell_list);
+
+        auto_column.sample = {};
+        auto_column.cell_list = {};
     }
+}
 
-    if (reader.hasError()) {
-        qWarning() << "ParseSheet error:" << reader.errorString();
+/*!
+ * \internal
+ * Adds the number of cells referring to each shared string to \a count_list.
+ */
+void Worksheet::CountSharedString(QList<int>& count_list) const
+{
+    for (const auto& row_entry : matrix_) {
+        for (const auto& entry : row_entry.entry_list) {
+            if (entry.cell.type != CellType::kSharedString || !entry.cell.value.isValid())
+                continue;
+
+            const int index { entry.cell.value.toInt() };
+            if (index >= 0 && index < count_list.size())
+                ++count_list[index];
+        }
     }
 }
 
-void Worksheet::ParseRow(QXmlStreamReader& reader)
+void Worksheet::CountCellType(QHash<CellType, qint64>& count_hash) const
 {
-    Q_ASSERT(reader.name() == QStringLiteral("row"));
+    for (const auto& row_entry : matrix_) {
+        for (const auto& entry : row_entry.entry_list)
+            ++count_hash[entry.cell.type];
+    }
+}
 
-    while (reader.readNextStartElement()) {
-        if (reader.name() == QStringLiteral("c")) {
-            ProcessCell(reader);
-        } else {
-            reader.skipCurrentElement();
+/*!
+ * Returns the heap held by the cell store, the inline string cells and the load and write scratch state.
+ */
+MemoryFootprint Worksheet::MemoryUsage() const
+{
+    MemoryFootprint footprint {};
+    footprint.cell_store = matrix_.MemoryUsage() + Utility::HeapSize(raw_row_.cells) + Utility::HeapSize(auto_string_hash_);
+
+    for (const auto& raw_cell : raw_row_.cells)
+        footprint.cell_store += Utility::HeapSize(raw_cell.text) + Utility::HeapSize(raw_cell.utf8);
+
+    for (const auto& auto_column : auto_string_hash_)
+        footprint.cell_store += Utility::HeapSize(auto_column.sample) + Utility::HeapSize(auto_column.cell_list);
+
+    for (const auto& row_entry : matrix_) {
+        for (const auto& entry : row_entry.entry_list) {
+            // Other values fit in the cell's QVariant.
+            if (const QByteArray* text { get_if<QByteArray>(&entry.cell.value) })
+                footprint.inline_string += Utility::HeapSize(*text);
+            else if (const QString* string { get_if<QString>(&entry.cell.value) })
+                footprint.inline_string += Utility::HeapSize(*string);
         }
     }
+
+    return footprint;
 }
 
-void Worksheet::ProcessCell(QXmlStreamReader& reader)
+/*!
+ * \internal
+ * Rewrites the shared string index of every cell through \a remap, see SharedString::Compact().
+ */
+void Worksheet::RemapSharedString(const QList<int>& remap)
 {
-    Q_ASSERT(reader.name() == QStringLiteral("c"));
+    for (auto& row_entry : matrix_) {
+        for (auto& entry : row_entry.entry_list) {
+            if (entry.cell.type == CellType::kSharedString && entry.cell.value.isValid())
+                entry.cell.value = remap.value(entry.cell.value.toInt(), -1);
+        }
+    }
+}
 
-    // Read cell attributes
-    QXmlStreamAttributes attributes { reader.attributes() };
+/*!
+        Write a empty cell (\a row, \a column) with the \a format.
+        Returns true on success.
+ */
+bool Worksheet::WriteBlank(int row, int column)
+{
+    // Note: NumberType with an invalid QVariant value means blank.
+    WriteMatrix(row, column, Cell { QVariant {}, CellType::kNumber });
+    return true;
+}
 
-    const QString cell_reference { attributes.value(QLatin1String("r")).toString() };
-    const Coordinate coord { cell_reference };
+/*!
+ * \internal
+ */
+void Worksheet::ComposeXml(QIODevice* device) const
+{
+    relationship_->Clear();
+    QXmlStreamWriter writer(device);
+    writer.writeStartDocument(QLatin1String("1.0"), true);
+    writer.writeStartElement(QLatin1String("worksheet"));
+    writer.writeAttribute(QLatin1String("xmlns"), QLatin1String("http://schemas.openxmlformats.org/spreadsheetml/2006/main"));
+    writer.writeAttribute(QLatin1String("xmlns:r"), QLatin1String("http://schemas.openxmlformats.org/officeDocument/2006/relationships"));
 
-    if (!coord.IsValid()) {
-        qWarning() << "Invalid cell reference:" << cell_reference << "at line" << reader.lineNumber() << "column" << reader.columnNumber();
-        reader.skipCurrentElement();
-        return;
-    }
+    writer.writeStartElement(QLatin1String("dimension"));
+    writer.writeAttribute(QLatin1String("ref"), ComposeDimension());
+    writer.writeEndElement(); // dimension
 
-    // Determine cell type
-    CellType cell_type { CellType::kNumber }; // default type is Number
-
-    if (attributes.hasAttribute(QLatin1String("t"))) {
-        const QString type { attributes.value(QLatin1String("t")).toString() };
-
-        if (type == QLatin1String("s"))
-            cell_type = CellType::kSharedString;
-        else if (type == QLatin1String("inlineStr"))
-            cell_type = CellType::kInlineString;
-        else if (type == QLatin1String("str"))
-            cell_type = CellType::kInlineString; // Formula string result, treated as plain string.
-        else if (type == QLatin1String("b"))
-            cell_type = CellType::kBoolean;
-        else if (type == QLatin1String("d"))
-            cell_type = CellType::kDateTime;
-        else if (type == QLatin1String("e"))
-            cell_type = CellType::kError;
-        else if (type == QLatin1String("n"))
-            cell_type = CellType::kNumber;
-        // otherwise keep default Number
-    }
+    writer.writeStartElement(QLatin1String("sheetViews"));
+    writer.writeStartElement(QLatin1String("sheetView"));
+    writer.writeAttribute(QLatin1String("workbookViewId"), QLatin1String("0"));
+    writer.writeEndElement(); // sheetView
+    writer.writeEndElement(); // sheetViews
 
-    // Create cell
-    auto cell { QSharedPointer<Cell>::create(QVariant {}, cell_type) };
-
-    // Parse sub-elements of the cell
-    while (reader.readNextStartElement()) {
-        if (reader.name() == QStringLiteral("v")) {
-            const QString value { reader.readElementText() };
-            cell->value = ParseCellValue(value, cell_type);
-        } else if (reader.name() == QStringLiteral("is")) {
-            // inline string structure
-            while (reader.readNextStartElement()) {
-                if (reader.name() == QStringLiteral("t")) {
-                    const QString text = reader.readElementText();
-                    cell->value = text;
-                } else {
-                    reader.skipCurrentElement();
-                }
-            }
+    writer.writeStartElement(QLatin1String("sheetFormatPr"));
+    writer.writeAttribute(QLatin1String("defaultRowHeight"), QString::number(sheet_format_props_.default_row_height));
+    writer.writeAttribute(QLatin1String("defaultColWidth"), QString::number(sheet_format_props_.default_col_width));
+    writer.writeEndElement(); // sheetFormatPr
 
-        } else {
-            // Skip unknown sub-elements
-            reader.skipCurrentElement();
-        }
-    }
+    // -------------------
+    // Add column definitions for shrinkToFit to work
+    // -------------------
+    writer.writeStartElement(QLatin1String("cols"));
+    writer.writeStartElement(QLatin1String("col"));
+    writer.writeAttribute(QLatin1String("min"), QLatin1String("1"));
+    writer.writeAttribute(QLatin1String("max"), QLatin1String("16384")); // Excel max columns
+    writer.writeAttribute(QLatin1String("width"), QLatin1String("12"));
+    writer.writeAttribute(QLatin1String("customWidth"), QLatin1String("1"));
+    writer.writeEndElement(); // col
+    writer.writeEndElement(); // cols
 
-    if (reader.hasError()) {
-        qWarning() << "XML Parsing Error in <c> at"
-                   << "row:" << coord.Row() << "col:" << coord.Column() << reader.errorString();
-    }
+    writer.writeStartElement(QLatin1String("sheetData"));
+    if (dimension_.IsValid())
+        ComposeSheet(writer);
+    writer.writeEndElement(); // sheetData
 
-    // Write cell to the matrix
-    WriteMatrix(coord.Row(), coord.Column(), cell);
+    writer.writeEndElement(); // worksheet
+    writer.writeEndDocument();
 }
 
-QVariant Worksheet::ParseCellValue(const QString& value, CellType cell_type)
+void Worksheet::ComposeSheet(QXmlStreamWriter& writer) const
 {
-    switch (cell_type) {
-    case CellType::kSharedString: {
-        bool ok = false;
-        int index = value.toInt(&ok);
+    for (const auto& [row, entry_list] : matrix_) {
+        writer.writeStartElement(QStringLiteral("row"));
+        writer.writeAttribute(QStringLiteral("r"), QString::number(row));
+        writer.writeAttribute(QStringLiteral("spans"), QStringLiteral("%1:%2").arg(entry_list.constFirst().column).arg(entry_list.constLast().column));
 
-        if (!ok || !shared_string_) {
-            return QVariant();
+        for (const auto& entry : entry_list) {
+            if (entry.cell.value.isValid())
+                CellCodec::ComposeCell(writer, row, entry.column, entry.cell, shared_string_.data());
         }
 
-        shared_string_->IncrementReference(index);
-        return shared_string_->GetSharedString(index);
-    }
-    case CellType::kBoolean: {
-        const QString lower = value.toLower();
-        return QVariant(lower == QLatin1String("true") || lower == QLatin1String("1"));
-    }
-    case CellType::kDateTime: {
-        QDateTime dt = QDateTime::fromString(value, Qt::ISODate);
-        if (!dt.isValid()) {
-            qWarning() << "Invalid date value.";
-        }
-        return QVariant::fromValue(dt);
-    }
-    case CellType::kNumber: {
-        bool ok = false;
-        double d = value.toDouble(&ok);
-        if (!ok) {
-            qWarning() << "Invalid numeric value.";
-        }
-        return QVariant(d);
+        writer.writeEndElement();
     }
-    case CellType::kInlineString:
-        return value;
-    default:
-        qWarning() << "Unsupported cell type, returning raw value.";
-        return value;
+}
+
+/*!
+ * Decodes the cells of an accepted row and writes them to the matrix.
+ */
+void Worksheet::StoreRow(const RawRow& row)
+{
+    const bool has_filter { load_options_.HasFilter() };
+
+    for (const auto& raw_cell : row.cells) {
+        // A cell without <v> or <is> stays empty.
+        QVariant value { raw_cell.IsEmpty() ? QVariant {} : CellCodec::ParseCellValue(raw_cell, shared_string_.data()) };
+        if (has_filter)
+            dimension_.Extend(row.row, raw_cell.column);
+
+        WriteMatrix(row.row, raw_cell.column, Cell { std::move(value), raw_cell.type });
     }
 }
 
 bool Worksheet::ParseXml(QIODevice* device)
 {
+    YXLSX_TRACE_SCOPE("Worksheet::ParseXml", xml_path_);
+
     if (!device || !device->isOpen()) {
         qWarning() << "Invalid or unopened QIODevice.";
         return false;
     }
 
-    QXmlStreamReader reader(device);
-    QStringView name {};
+    RowReader row_reader(device, load_options_, shared_string_.data());
 
-    while (!reader.atEnd() && !reader.hasError()) {
-        if (!reader.readNextStartElement())
-            continue;
-
-        name = reader.name();
+    if (row_reader.ReadHeader()) {
+        const Dimension& dimension { row_reader.GetDimension() };
 
-        if (name == QStringLiteral("dimension")) {
-            QXmlStreamAttributes attributes = reader.attributes();
-            QString range = attributes.value(QLatin1String("ref")).toString();
-            dimension_ = Dimension(range);
-        } else if (name == QStringLiteral("sheetData")) {
-            ParseSheet(reader);
+        // A filtered load rebuilds the dimension from the cells it keeps, the file's one only sizes the store.
+        if (load_options_.HasFilter()) {
+            const int column_count { load_options_.columns.isEmpty() ? dimension.ColumnCount() : static_cast<int>(load_options_.columns.size()) };
+            const int row_count { std::min(dimension.BottomRow(), load_options_.last_row) - std::max(dimension.TopRow(), load_options_.first_row) + 1 };
+            matrix_.Reserve(row_count, column_count);
+        } else {
+            dimension_ = dimension;
+            matrix_.Reserve(dimension.RowCount(), dimension.ColumnCount());
         }
+
+        // Nothing after <sheetData> is loaded, the reader stops there.
+        while (row_reader.ReadRow(raw_row_))
+            StoreRow(raw_row_);
     }
 
-    if (reader.hasError()) {
-        qWarning() << "XML Parsing Error:" << reader.errorString();
+    if (row_reader.HasError()) {
+        qWarning() << "XML Parsing Error:" << row_reader.ErrorString();
         return false;
     }
 
@@ -24,6 +24,8 @@
 
 #include "zipreader.h"
 
+#include "tracescope.h"
+
 YXLSX_BEGIN_NAMESPACE
 
 ZipReader::ZipReader(const QString& file_path)
@@ -38,13 +40,21 @@ ZipReader::ZipReader(QIODevice* device)
     Init();
 }
 
+QByteArray ZipReader::GetFileData(const QString& file_path) const
+{
+    YXLSX_TRACE_SCOPE("ZipReader::GetFileData", file_path);
+    return reader_->fileData(file_path);
+}
+
 void ZipReader::Init()
 {
     file_path_.clear();
+    file_crc_hash_.clear();
 
     for (const auto& file : reader_->fileInfoList()) {
         if (file.isFile || (!file.isDir && !file.isSymLink)) {
             file_path_.append(file.filePath);
+            file_crc_hash_.insert(file.filePath, file.crc);
         }
     }
 }
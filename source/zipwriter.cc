@@ -24,6 +24,8 @@
 
 #include "zipwriter.h"
 
+#include "tracescope.h"
+
 YXLSX_BEGIN_NAMESPACE
 
 ZipWriter::ZipWriter(const QString& file_path)
@@ -38,4 +40,16 @@ ZipWriter::ZipWriter(QIODevice* device)
     writer_->setCompressionPolicy(QZipWriter::AutoCompress);
 }
 
+void ZipWriter::AddFile(const QString& file_path, QIODevice* device)
+{
+    YXLSX_TRACE_SCOPE("ZipWriter::AddFile", file_path);
+    writer_->addFile(file_path, device);
+}
+
+void ZipWriter::AddFile(const QString& file_path, const QByteArray& data)
+{
+    YXLSX_TRACE_SCOPE("ZipWriter::AddFile", file_path);
+    writer_->addFile(file_path, data);
+}
+
 YXLSX_END_NAMESPACE
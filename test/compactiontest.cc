@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "document.h"
+#include "zipreader.h"
+
+namespace {
+
+QByteArray ReadSharedStringPart(const QString& path)
+{
+    yxlsx::ZipReader reader(path);
+    return reader.GetFileData(QStringLiteral("xl/sharedStrings.xml"));
+}
+
+}
+
+class CompactionTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void DropUnusedStrings();
+};
+
+// Strings no cell refers to after overwriting cells and deleting a sheet are dropped on save,
+// the rest are renumbered most used first and the cells read back their own text.
+void CompactionTest::DropUnusedStrings()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString before_path { dir.filePath(QStringLiteral("before.xlsx")) };
+    const QString after_path { dir.filePath(QStringLiteral("after.xlsx")) };
+
+    yxlsx::Document document {};
+    const auto workbook { document.GetWorkbook() };
+    workbook->SetSharedStringOrder(yxlsx::StringOrder::kFrequency);
+
+    const auto sheet { workbook->GetCurrentWorksheet() };
+    sheet->Write(1, 1, QStringLiteral("rare"));
+    for (int row = 2; row <= 6; ++row)
+        sheet->Write(row, 1, QStringLiteral("common"));
+    sheet->Write(7, 1, QStringLiteral("overwritten"));
+    sheet->Write(8, 1, QStringLiteral("replaced by a number"));
+    sheet->Write(9, 1, QStringLiteral("middle"));
+    sheet->Write(10, 1, QStringLiteral("middle"));
+
+    const auto other { workbook->AppendSheet(QStringLiteral("Other")).staticCast<yxlsx::Worksheet>() };
+    QVERIFY(other);
+    other->Write(1, 1, QStringLiteral("only on the deleted sheet"));
+    other->Write(2, 1, QStringLiteral("common"));
+
+    QVERIFY(document.Save(before_path));
+
+    // "overwritten" and "replaced by a number" lose their only cell, "middle" gets a third one.
+    sheet->Write(7, 1, QStringLiteral("middle"));
+    sheet->Write(8, 1, 42);
+    QVERIFY(workbook->DeleteSheet(QStringLiteral("Other")));
+
+    QVERIFY(document.Save(after_path));
+
+    const QByteArray before_part { ReadSharedStringPart(before_path) };
+    const QByteArray after_part { ReadSharedStringPart(after_path) };
+    QVERIFY(before_part.contains("uniqueCount=\"6\""));
+    QVERIFY(after_part.contains("uniqueCount=\"3\""));
+    QVERIFY(after_part.size() < before_part.size());
+
+    QVERIFY(!after_part.contains("overwritten"));
+    QVERIFY(!after_part.contains("replaced by a number"));
+    QVERIFY(!after_part.contains("only on the deleted sheet"));
+
+    // Most used first: common (5 cells), middle (3), rare (1).
+    const qsizetype common { after_part.indexOf("<t>common</t>") };
+    const qsizetype middle { after_part.indexOf("<t>middle</t>") };
+    const qsizetype rare { after_part.indexOf("<t>rare</t>") };
+    QVERIFY(common >= 0 && middle >= 0 && rare >= 0);
+    QVERIFY(common < middle);
+    QVERIFY(middle < rare);
+
+    yxlsx::Document loaded(after_path);
+    QVERIFY(loaded.IsLoadXlsx());
+    QCOMPARE(loaded.GetWorkbook()->GetSheetCount(), 1);
+
+    const auto loaded_sheet { loaded.GetWorkbook()->GetCurrentWorksheet() };
+    QCOMPARE(loaded_sheet->Read(1, 1).toString(), QStringLiteral("rare"));
+    for (int row = 2; row <= 6; ++row)
+        QCOMPARE(loaded_sheet->Read(row, 1).toString(), QStringLiteral("common"));
+    QCOMPARE(loaded_sheet->Read(7, 1).toString(), QStringLiteral("middle"));
+    QCOMPARE(loaded_sheet->Read(8, 1).toDouble(), 42.0);
+    QCOMPARE(loaded_sheet->Read(9, 1).toString(), QStringLiteral("middle"));
+    QCOMPARE(loaded_sheet->Read(10, 1).toString(), QStringLiteral("middle"));
+}
+
+QTEST_GUILESS_MAIN(CompactionTest)
+
+#include "compactiontest.moc"
@@ -0,0 +1,228 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "document.h"
+#include "recordreader.h"
+
+namespace {
+
+struct Entry {
+    qint64 id {};
+    QString name {};
+    std::optional<double> amount {};
+};
+
+struct Dated {
+    std::optional<QDateTime> date {};
+};
+
+// Saves a workbook filled by fill to dir and returns its path, sheet_name is set to its only sheet.
+template <typename Fill> QString SaveWorkbook(const QTemporaryDir& dir, QString& sheet_name, Fill fill)
+{
+    const QString path { dir.filePath(QStringLiteral("records.xlsx")) };
+
+    yxlsx::Document document {};
+    fill(*document.GetWorkbook()->GetCurrentWorksheet());
+    sheet_name = document.GetWorkbook()->GetSheetName().constFirst();
+
+    return document.Save(path) ? path : QString();
+}
+
+}
+
+class RecordReaderTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void ReadFixedLayoutWithConversionError();
+    void ReadSerialDate_data();
+    void ReadSerialDate();
+    void KeepCallerColumnFilter();
+    void PredicateWithoutColumnFilter();
+};
+
+// A cell that does not convert leaves its member value-initialized and is reported, reading goes on.
+void RecordReaderTest::ReadFixedLayoutWithConversionError()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    QString sheet_name {};
+    const QString path { SaveWorkbook(dir, sheet_name, [](yxlsx::Worksheet& sheet) {
+        sheet.Write(1, 1, 1);
+        sheet.Write(1, 2, QStringLiteral("first"));
+        sheet.Write(1, 3, 10.5);
+
+        sheet.Write(2, 1, 2);
+        sheet.Write(2, 2, QStringLiteral("second"));
+        sheet.Write(2, 3, QStringLiteral("not a number"));
+
+        sheet.Write(3, 1, 3);
+        sheet.Write(3, 2, QStringLiteral("third"));
+        sheet.Write(3, 3, QStringLiteral(" 7.25 "));
+    }) };
+    QVERIFY(!path.isEmpty());
+
+    yxlsx::RecordReader reader(
+        path, sheet_name, std::tuple { yxlsx::Field { 1, &Entry::id }, yxlsx::Field { 2, &Entry::name }, yxlsx::Field { 3, &Entry::amount } });
+
+    QList<Entry> entry_list {};
+    Entry entry {};
+    while (reader.Next(entry))
+        entry_list.append(entry);
+
+    QCOMPARE(entry_list.size(), 3);
+
+    QCOMPARE(entry_list.at(0).id, qint64(1));
+    QCOMPARE(entry_list.at(0).name, QStringLiteral("first"));
+    QVERIFY(entry_list.at(0).amount.has_value());
+    QCOMPARE(*entry_list.at(0).amount, 10.5);
+
+    QCOMPARE(entry_list.at(1).id, qint64(2));
+    QCOMPARE(entry_list.at(1).name, QStringLiteral("second"));
+    QVERIFY(!entry_list.at(1).amount.has_value());
+
+    QCOMPARE(entry_list.at(2).id, qint64(3));
+    QVERIFY(entry_list.at(2).amount.has_value());
+    QCOMPARE(*entry_list.at(2).amount, 7.25);
+
+    QCOMPARE(reader.GetError().size(), 1);
+    QCOMPARE(reader.GetError().constFirst().row, 2);
+    QCOMPARE(reader.GetError().constFirst().column, 3);
+    QCOMPARE(reader.GetError().constFirst().type, yxlsx::CellType::kSharedString);
+}
+
+void RecordReaderTest::ReadSerialDate_data()
+{
+    QTest::addColumn<double>("serial");
+    QTest::addColumn<QDateTime>("expected");
+
+    QTest::newRow("1900-01-01") << 1.0 << QDateTime(QDate(1900, 1, 1), QTime(0, 0));
+    QTest::newRow("1900-02-28 noon") << 59.5 << QDateTime(QDate(1900, 2, 28), QTime(12, 0));
+    QTest::newRow("1900-02-29") << 60.0 << QDateTime();
+    QTest::newRow("1900-03-01") << 61.0 << QDateTime(QDate(1900, 3, 1), QTime(0, 0));
+    QTest::newRow("2024-01-31") << 45322.0 << QDateTime(QDate(2024, 1, 31), QTime(0, 0));
+}
+
+// Serial dates follow Excel's 1900 date system, including its fictitious 1900-02-29.
+void RecordReaderTest::ReadSerialDate()
+{
+    QFETCH(double, serial);
+    QFETCH(QDateTime, expected);
+
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    QString sheet_name {};
+    const QString path { SaveWorkbook(dir, sheet_name, [serial](yxlsx::Worksheet& sheet) { sheet.Write(1, 1, serial); }) };
+    QVERIFY(!path.isEmpty());
+
+    yxlsx::RecordReader reader(path, sheet_name, std::tuple { yxlsx::Field { 1, &Dated::date } });
+
+    Dated dated {};
+    QVERIFY(reader.Next(dated));
+
+    if (expected.isValid()) {
+        QVERIFY(dated.date.has_value());
+        QCOMPARE(*dated.date, expected);
+        QVERIFY(reader.GetError().isEmpty());
+    } else {
+        QVERIFY(!dated.date.has_value());
+        QCOMPARE(reader.GetError().size(), 1);
+    }
+}
+
+// A caller's column filter is extended with the schema's columns, not replaced or ignored.
+void RecordReaderTest::KeepCallerColumnFilter()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    QString sheet_name {};
+    const QString path { SaveWorkbook(dir, sheet_name, [](yxlsx::Worksheet& sheet) {
+        for (int row = 1; row <= 4; ++row) {
+            sheet.Write(row, 1, row);
+            sheet.Write(row, 2, QStringLiteral("name %1").arg(row));
+            sheet.Write(row, 5, row % 2 == 0 ? QStringLiteral("keep") : QStringLiteral("drop"));
+        }
+    }) };
+    QVERIFY(!path.isEmpty());
+
+    yxlsx::LoadOptions options {};
+    options.columns = { 5 };
+    options.row_predicate = yxlsx::LoadOptions::ColumnEquals(5, QStringLiteral("keep"));
+
+    yxlsx::RecordReader reader(path, sheet_name, std::tuple { yxlsx::Field { 1, &Entry::id }, yxlsx::Field { 2, &Entry::name } }, options);
+
+    QList<Entry> entry_list {};
+    Entry entry {};
+    while (reader.Next(entry))
+        entry_list.append(entry);
+
+    QCOMPARE(entry_list.size(), 2);
+    QCOMPARE(entry_list.at(0).id, qint64(2));
+    QCOMPARE(entry_list.at(0).name, QStringLiteral("name 2"));
+    QCOMPARE(entry_list.at(1).id, qint64(4));
+    QCOMPARE(entry_list.at(1).name, QStringLiteral("name 4"));
+}
+
+// A predicate on a column outside the schema sees that column when the caller gave no column filter.
+void RecordReaderTest::PredicateWithoutColumnFilter()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    QString sheet_name {};
+    const QString path { SaveWorkbook(dir, sheet_name, [](yxlsx::Worksheet& sheet) {
+        for (int row = 1; row <= 4; ++row) {
+            sheet.Write(row, 1, row);
+            sheet.Write(row, 2, QStringLiteral("name %1").arg(row));
+            sheet.Write(row, 5, row % 2 == 0 ? QStringLiteral("keep") : QStringLiteral("drop"));
+        }
+    }) };
+    QVERIFY(!path.isEmpty());
+
+    yxlsx::LoadOptions options {};
+    options.row_predicate = yxlsx::LoadOptions::ColumnEquals(5, QStringLiteral("keep"));
+
+    yxlsx::RecordReader reader(path, sheet_name, std::tuple { yxlsx::Field { 1, &Entry::id }, yxlsx::Field { 2, &Entry::name } }, options);
+
+    QList<Entry> entry_list {};
+    Entry entry {};
+    while (reader.Next(entry))
+        entry_list.append(entry);
+
+    QCOMPARE(entry_list.size(), 2);
+    QCOMPARE(entry_list.at(0).id, qint64(2));
+    QCOMPARE(entry_list.at(0).name, QStringLiteral("name 2"));
+    QCOMPARE(entry_list.at(1).id, qint64(4));
+    QCOMPARE(entry_list.at(1).name, QStringLiteral("name 4"));
+}
+
+QTEST_GUILESS_MAIN(RecordReaderTest)
+
+#include "recordreadertest.moc"
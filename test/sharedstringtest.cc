@@ -0,0 +1,154 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "document.h"
+#include "zipreader.h"
+#include "zipwriter.h"
+
+class SharedStringTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void LoadPlainPart_data();
+    void LoadPlainPart();
+    void LoadPrefixedPart_data();
+    void LoadPrefixedPart();
+};
+
+void SharedStringTest::LoadPlainPart_data()
+{
+    QTest::addColumn<bool>("lazy");
+
+    QTest::newRow("eager") << false;
+    QTest::newRow("lazy") << true;
+}
+
+// The part as this library writes it is read as bytes in both modes, escaped and non-ASCII text included.
+// Inline strings come back from the sheet the same way.
+void SharedStringTest::LoadPlainPart()
+{
+    QFETCH(bool, lazy);
+
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString path { dir.filePath(QStringLiteral("plain.xlsx")) };
+    const QString umlaut { QStringLiteral("Gr\u00FC\u00DFe \u4E16\u754C") };
+
+    {
+        yxlsx::Document document {};
+        const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+        sheet->Write(1, 1, QStringLiteral("alpha"));
+        sheet->Write(2, 1, QStringLiteral("beta & <gamma>"));
+        sheet->Write(3, 1, umlaut);
+        sheet->Write(4, 1, QStringLiteral("alpha"));
+        sheet->Write(1, 2, umlaut, yxlsx::StringType::kInlineString);
+        sheet->Write(2, 2, QStringLiteral("a & b"), yxlsx::StringType::kInlineString);
+        QVERIFY(document.Save(path));
+    }
+
+    yxlsx::LoadOptions options {};
+    options.lazy_shared_string = lazy;
+
+    yxlsx::Document document(path, options);
+    QVERIFY(document.IsLoadXlsx());
+    QCOMPARE(document.GetWorkbook()->GetSharedString()->Count(), qsizetype(3));
+
+    const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+    QCOMPARE(sheet->Read(1, 1).toString(), QStringLiteral("alpha"));
+    QCOMPARE(sheet->Read(2, 1).toString(), QStringLiteral("beta & <gamma>"));
+    QCOMPARE(sheet->Read(3, 1).toString(), umlaut);
+    QCOMPARE(sheet->Read(4, 1).toString(), QStringLiteral("alpha"));
+    QCOMPARE(sheet->Read(1, 2).toString(), umlaut);
+    QCOMPARE(sheet->Read(2, 2).toString(), QStringLiteral("a & b"));
+}
+
+void SharedStringTest::LoadPrefixedPart_data()
+{
+    QTest::addColumn<bool>("lazy");
+
+    QTest::newRow("eager") << false;
+    QTest::newRow("lazy") << true;
+}
+
+// A sharedStrings part whose elements carry a namespace prefix, as some writers emit, loads the same strings.
+void SharedStringTest::LoadPrefixedPart()
+{
+    QFETCH(bool, lazy);
+
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString plain_path { dir.filePath(QStringLiteral("plain.xlsx")) };
+    const QString prefixed_path { dir.filePath(QStringLiteral("prefixed.xlsx")) };
+
+    {
+        yxlsx::Document document {};
+        const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+        sheet->Write(1, 1, QStringLiteral("alpha"));
+        sheet->Write(2, 1, QStringLiteral("beta & gamma"));
+        sheet->Write(3, 1, QStringLiteral(" padded "));
+        QVERIFY(document.Save(plain_path));
+    }
+
+    {
+        yxlsx::ZipReader reader(plain_path);
+        yxlsx::ZipWriter writer(prefixed_path);
+
+        for (const QString& path : reader.GetFilePath()) {
+            QByteArray data { reader.GetFileData(path) };
+
+            if (path.endsWith(QStringLiteral("sharedStrings.xml"))) {
+                data.replace("xmlns=", "xmlns:x=");
+                data.replace("<sst ", "<x:sst ").replace("</sst>", "</x:sst>");
+                data.replace("<si>", "<x:si>").replace("</si>", "</x:si>");
+                data.replace("<t>", "<x:t>").replace("<t ", "<x:t ").replace("</t>", "</x:t>");
+                QVERIFY(data.contains("<x:sst "));
+            }
+
+            writer.AddFile(path, data);
+        }
+
+        writer.Close();
+        QVERIFY(!writer.IsError());
+    }
+
+    yxlsx::LoadOptions options {};
+    options.lazy_shared_string = lazy;
+
+    yxlsx::Document document(prefixed_path, options);
+    QVERIFY(document.IsLoadXlsx());
+
+    const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+    QCOMPARE(sheet->Read(1, 1).toString(), QStringLiteral("alpha"));
+    QCOMPARE(sheet->Read(2, 1).toString(), QStringLiteral("beta & gamma"));
+    QCOMPARE(sheet->Read(3, 1).toString(), QStringLiteral(" padded "));
+}
+
+QTEST_GUILESS_MAIN(SharedStringTest)
+
+#include "sharedstringtest.moc"
@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2024 YTX
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "document.h"
+#include "snapshot.h"
+
+namespace {
+
+// Saves a one-sheet workbook holding text in A1 and 42 in A2 to path.
+bool SaveWorkbook(const QString& path, const QString& text)
+{
+    yxlsx::Document document {};
+    const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+    sheet->Write(1, 1, text);
+    sheet->Write(2, 1, 42);
+    return document.Save(path);
+}
+
+QByteArray ReadFile(const QString& path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+bool WriteFile(const QString& path, const QByteArray& data)
+{
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(data) == data.size();
+}
+
+yxlsx::LoadOptions SnapshotOptions()
+{
+    yxlsx::LoadOptions options {};
+    options.use_snapshot = true;
+    options.collect_stats = true;
+    return options;
+}
+
+}
+
+class SnapshotTest final : public QObject {
+    Q_OBJECT
+
+private slots:
+    void LoadFromSnapshot();
+    void RejectChangedContent();
+    void FallBackOnBrokenSnapshot_data();
+    void FallBackOnBrokenSnapshot();
+};
+
+// The first load writes the snapshot, the second one is served from it without inflating a part.
+void SnapshotTest::LoadFromSnapshot()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString path { dir.filePath(QStringLiteral("book.xlsx")) };
+    QVERIFY(SaveWorkbook(path, QStringLiteral("value A")));
+
+    {
+        yxlsx::Document document(path, SnapshotOptions());
+        QVERIFY(document.IsLoadXlsx());
+        QVERIFY(document.GetStats().bytes_inflated > 0);
+    }
+
+    QVERIFY(QFile::exists(yxlsx::Snapshot::SnapshotPath(path)));
+
+    yxlsx::Document document(path, SnapshotOptions());
+    QVERIFY(document.IsLoadXlsx());
+    QCOMPARE(document.GetStats().bytes_inflated, qint64(0));
+    QCOMPARE(document.GetStats().shared_string_read, qint64(1));
+
+    const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+    QCOMPARE(sheet->Read(1, 1).toString(), QStringLiteral("value A"));
+    QCOMPARE(sheet->Read(2, 1).toDouble(), 42.0);
+}
+
+// A file replaced by one of the same size and mtime but other content does not use the old snapshot.
+void SnapshotTest::RejectChangedContent()
+{
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString path { dir.filePath(QStringLiteral("book.xlsx")) };
+    QVERIFY(SaveWorkbook(path, QStringLiteral("value A")));
+
+    {
+        yxlsx::Document document(path, SnapshotOptions());
+        QVERIFY(document.IsLoadXlsx());
+    }
+
+    QVERIFY(QFile::exists(yxlsx::Snapshot::SnapshotPath(path)));
+
+    // Deflate may size similar parts differently, look for a replacement of the same size.
+    const QByteArray original { ReadFile(path) };
+    const QString variant_path { dir.filePath(QStringLiteral("variant.xlsx")) };
+
+    QString variant_text {};
+    QByteArray variant {};
+    for (char letter = 'B'; letter <= 'Z' && variant_text.isEmpty(); ++letter) {
+        const QString text { QStringLiteral("value ") + QLatin1Char(letter) };
+        QVERIFY(SaveWorkbook(variant_path, text));
+
+        const QByteArray data { ReadFile(variant_path) };
+        if (data.size() == original.size() && data != original) {
+            variant_text = text;
+            variant = data;
+        }
+    }
+
+    QVERIFY2(!variant_text.isEmpty(), "no replacement of the same size");
+
+    const QDateTime mtime { QFileInfo(path).lastModified() };
+    QVERIFY(WriteFile(path, variant));
+
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        QVERIFY(file.setFileTime(mtime, QFileDevice::FileModificationTime));
+    }
+
+    QCOMPARE(QFileInfo(path).size(), qint64(original.size()));
+    QCOMPARE(QFileInfo(path).lastModified().toMSecsSinceEpoch(), mtime.toMSecsSinceEpoch());
+
+    yxlsx::Document document(path, SnapshotOptions());
+    QVERIFY(document.IsLoadXlsx());
+    QVERIFY(document.GetStats().bytes_inflated > 0);
+    QCOMPARE(document.GetWorkbook()->GetCurrentWorksheet()->Read(1, 1).toString(), variant_text);
+}
+
+void SnapshotTest::FallBackOnBrokenSnapshot_data()
+{
+    QTest::addColumn<QString>("damage");
+
+    QTest::newRow("truncated") << QStringLiteral("truncated");
+    QTest::newRow("header only") << QStringLiteral("header only");
+    QTest::newRow("wrong magic") << QStringLiteral("wrong magic");
+    QTest::newRow("empty") << QStringLiteral("empty");
+}
+
+// A broken snapshot is ignored, the package is parsed instead and the snapshot written again,
+// so the next load is served from it.
+void SnapshotTest::FallBackOnBrokenSnapshot()
+{
+    QFETCH(QString, damage);
+
+    QTemporaryDir dir {};
+    QVERIFY(dir.isValid());
+
+    const QString path { dir.filePath(QStringLiteral("book.xlsx")) };
+    const QString snapshot_path { yxlsx::Snapshot::SnapshotPath(path) };
+    QVERIFY(SaveWorkbook(path, QStringLiteral("value A")));
+
+    {
+        yxlsx::Document document(path, SnapshotOptions());
+        QVERIFY(document.IsLoadXlsx());
+    }
+
+    const QByteArray snapshot { ReadFile(snapshot_path) };
+    QVERIFY(snapshot.size() > 16);
+
+    QByteArray broken {};
+    if (damage == QStringLiteral("truncated"))
+        broken = snapshot.first(snapshot.size() / 2);
+    else if (damage == QStringLiteral("header only"))
+        broken = snapshot.first(6);
+    else if (damage == QStringLiteral("wrong magic"))
+        broken = QByteArray("XXXX") + snapshot.sliced(4);
+
+    QVERIFY(WriteFile(snapshot_path, broken));
+
+    yxlsx::Document document(path, SnapshotOptions());
+    QVERIFY(document.IsLoadXlsx());
+    QVERIFY(document.GetStats().bytes_inflated > 0);
+
+    const auto sheet { document.GetWorkbook()->GetCurrentWorksheet() };
+    QCOMPARE(sheet->Read(1, 1).toString(), QStringLiteral("value A"));
+    QCOMPARE(sheet->Read(2, 1).toDouble(), 42.0);
+
+    yxlsx::Document reloaded(path, SnapshotOptions());
+    QVERIFY(reloaded.IsLoadXlsx());
+    QCOMPARE(reloaded.GetStats().bytes_inflated, qint64(0));
+    QCOMPARE(reloaded.GetWorkbook()->GetCurrentWorksheet()->Read(1, 1).toString(), QStringLiteral("value A"));
+}
+
+QTEST_GUILESS_MAIN(SnapshotTest)
+
+#include "snapshottest.moc"